@@ -16,18 +16,20 @@ case "$1" in
 
         # decorate 
         sleep 0.1
-        oat decorate RAW FINAL -p ORNG BLUE -sSRt &
+        oat decorate RAW FINAL -p LED_orange LED_blue -sSRt &
 
         sleep 0.1
         oat posifilt kalman COMBO FILT -c config.toml -k kalman &
 
         sleep 0.1
-        oat posicom mean BLUE ORNG COMBO -c config.toml -k mean &
+        oat posicom mean LED_blue LED_orange COMBO -c config.toml -k mean &
 
-        # detecting orange and blue leds in raw data
+        # detecting orange and blue leds in raw data, classifying each pixel
+        # once for both colors. Separate hsv detectors can be used instead:
+        #oat posidet hsv SUB ORNG -c config.toml -k hsv_orange &
+        #oat posidet hsv SUB BLUE -c config.toml -k hsv_blue &
         sleep 0.1
-        oat posidet hsv SUB ORNG -c config.toml -k hsv_orange &
-        oat posidet hsv SUB BLUE -c config.toml -k hsv_blue &
+        oat posidet multihsv SUB LED -c config.toml -k hsv_leds &
 
         # apply mask to determine area of interest, path to mask file is in config
         sleep 0.1
@@ -44,7 +46,7 @@ case "$1" in
 
 	clean)
 
-		oat clean RAW AOI SUB ORNG BLUE COMBO FILT FINAL
+		oat clean RAW AOI SUB ORNG BLUE LED_orange LED_blue COMBO FILT FINAL
 		;;
 
 	*)
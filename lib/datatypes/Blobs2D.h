@@ -0,0 +1,168 @@
+//******************************************************************************
+//* File:   Blobs2D.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BLOBS2D_H
+#define	OAT_BLOBS2D_H
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <opencv2/core/types.hpp>
+
+#include "Sample.h"
+
+namespace oat {
+
+// Constants
+static constexpr size_t MAX_BLOBS {32};
+
+/**
+ * A single detected object candidate.
+ */
+struct Blob2D {
+    cv::Point2d centroid;   //!< Center of mass (pixels)
+    double area {0.0};      //!< Area (pixels^2)
+    cv::Rect bounding_box;  //!< Upright bounding rectangle (pixels)
+};
+
+/**
+ * Fixed capacity list of object candidates found in a single frame, ordered
+ * by decreasing area. Because it does not allocate, it can be published
+ * through a shared memory node.
+ */
+class Blobs2D {
+
+public:
+
+    explicit Blobs2D(const std::string &label)
+    {
+        strncpy(label_, label.c_str(), sizeof(label_));
+        label_[sizeof(label_) - 1] = '\0';
+    }
+
+    Blobs2D & operator = (const Blobs2D &b) {
+
+        // Check for self assignment
+        if (this == &b)
+            return *this;
+
+        // Copy all except label_
+        sample_ = b.sample_;
+        capacity_ = b.capacity_;
+        size_ = b.size_;
+        std::copy(b.blobs_, b.blobs_ + b.size_, blobs_);
+
+        return *this;
+    }
+
+    // Expose sample information for potential modification
+    oat::Sample & sample() { return sample_; };
+    const oat::Sample & sample() const { return sample_; };
+
+    // Accessors
+    char * label() {return label_; }
+    size_t size(void) const { return size_; }
+    size_t capacity(void) const { return capacity_; }
+    bool empty(void) const { return size_ == 0; }
+    const Blob2D & operator[](const size_t i) const { return blobs_[i]; }
+
+    /**
+     * @brief Limit the number of blobs kept. Clears the list.
+     * @param k Maximum number of blobs. Clamped to [1, MAX_BLOBS].
+     */
+    void set_capacity(const size_t k) {
+        capacity_ = std::max<size_t>(1, std::min(k, MAX_BLOBS));
+        size_ = 0;
+    }
+
+    void clear(void) { size_ = 0; }
+
+    /**
+     * @brief Offer a blob to the list. It is kept if the list is not full
+     * or it is larger than the smallest blob in the list.
+     * @return True if the blob was kept.
+     */
+    bool insert(const Blob2D &blob) {
+
+        if (size_ == capacity_) {
+            if (blob.area <= blobs_[size_ - 1].area)
+                return false;
+            size_--;
+        }
+
+        // Shift smaller blobs down to keep the list sorted
+        size_t i = size_++;
+        for (; i > 0 && blobs_[i - 1].area < blob.area; i--)
+            blobs_[i] = blobs_[i - 1];
+        blobs_[i] = blob;
+
+        return true;
+    }
+
+    /**
+     * @brief JSON Serializer
+     *
+     * @param writer Writer to use for serialization
+     */
+    template <typename Writer>
+    void Serialize(Writer &writer) const {
+
+        // Sample number
+        writer.String("tick");
+        writer.Int(sample_.count());
+
+        writer.String("usec");
+        writer.Int64(sample_.microseconds().count());
+
+        writer.String("blobs");
+        writer.StartArray();
+        for (size_t i = 0; i < size_; i++) {
+            const Blob2D &b = blobs_[i];
+            writer.StartObject();
+            writer.String("xy");
+            writer.StartArray();
+            writer.Double(b.centroid.x);
+            writer.Double(b.centroid.y);
+            writer.EndArray(2);
+            writer.String("area");
+            writer.Double(b.area);
+            writer.String("bbox");
+            writer.StartArray();
+            writer.Int(b.bounding_box.x);
+            writer.Int(b.bounding_box.y);
+            writer.Int(b.bounding_box.width);
+            writer.Int(b.bounding_box.height);
+            writer.EndArray(4);
+            writer.EndObject(3);
+        }
+        writer.EndArray(size_);
+    }
+
+private:
+
+    char label_[100] {0}; //!< Blob list label
+    oat::Sample sample_;
+
+    size_t capacity_ {MAX_BLOBS};
+    size_t size_ {0};
+    Blob2D blobs_[MAX_BLOBS];
+};
+
+}      /* namespace oat */
+#endif /* OAT_BLOBS2D_H */
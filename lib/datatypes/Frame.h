@@ -94,6 +94,23 @@ public:
         // Nothing
     }
 
+    // Copies that own their sample information must point to their own copy
+    // of it, not to that of the Frame they were copied from
+    Frame(const Frame &f) :
+      cv::Mat(f)
+    , sample_(f.sample_)
+    , sample_ptr_(f.sample_ptr_ == &f.sample_ ? &sample_ : f.sample_ptr_)
+    {
+        // Nothing
+    }
+
+    Frame & operator=(const Frame &f) {
+        cv::Mat::operator=(f);
+        sample_ = f.sample_;
+        sample_ptr_ = f.sample_ptr_ == &f.sample_ ? &sample_ : f.sample_ptr_;
+        return *this;
+    }
+
     Frame clone() const {
         Frame f(cv::Mat::clone());
         *(f.sample_ptr_) = *sample_ptr_;
@@ -56,6 +56,7 @@ public:
         unit_of_length_ = p.unit_of_length_;
         sample_ = p.sample_;
         position_valid = p.position_valid;
+        position_held = p.position_held;
         velocity_valid = p.velocity_valid;
         heading_valid = p.heading_valid;
         region_valid = p.region_valid;
@@ -67,6 +68,7 @@ public:
 
     // Expose sample information for potential modification
     oat::Sample & sample() { return sample_; };
+    const oat::Sample & sample() const { return sample_; };
 
     // Accessors
     char * label() {return label_; }
@@ -81,6 +83,9 @@ public:
     bool velocity_valid {false};
     bool heading_valid {false};
 
+    // Position was repeated from the previous sample without detection
+    bool position_held {false};
+
 protected:
     
     char label_[100] {0}; //!< Position label (e.g. "anterior")
@@ -84,6 +84,12 @@ public:
             writer.EndArray(2);
         }
 
+        // Held positions are repeated from the previous sample
+        if (position_held) {
+            writer.String("pos_hold");
+            writer.Bool(true);
+        }
+
         // Velocity
         writer.String("vel_ok");
         writer.Bool(velocity_valid || verbose);
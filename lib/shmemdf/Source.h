@@ -20,6 +20,7 @@
 #ifndef OAT_SOURCE_H
 #define	OAT_SOURCE_H
 
+#include <algorithm>
 #include <thread>
 #include <exception>
 #include <iostream>
@@ -72,6 +73,7 @@ public:
 
     // Sychronization
     NodeState wait();
+    bool wait_for(const int timeout_ms, NodeState &state);
     void post();
 
     uint64_t write_number() const {
@@ -221,6 +223,47 @@ inline NodeState SourceBase<T>::wait() {
     return node_->sink_state();
 }
 
+/**
+ * @brief Like wait(), but give up if the SINK has not published within
+ * timeout_ms, so that the caller can check its own state and wait again.
+ * @param timeout_ms Maximum waiting time (milliseconds).
+ * @param state Node state once the wait has been released. Not set if the
+ * wait timed out.
+ * @return False if the wait timed out, in which case post() must not be
+ * called.
+ */
+template<typename T>
+inline bool SourceBase<T>::wait_for(const int timeout_ms, NodeState &state) {
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(state_ < SourceState::TOUCHED)
+        throw std::runtime_error("Source must have touched node before calling wait_for()");
+    if (did_wait_need_post_)
+        throw std::runtime_error("wait_for() called when post() was required.");
+#endif
+
+    const boost::system_time deadline = boost::get_system_time() + msec_t(timeout_ms);
+    boost::system_time timeout = std::min(deadline, boost::get_system_time() + msec_t(10));
+
+    while (!node_->read_barrier(slot_index_).timed_wait(timeout)) {
+
+        // If the sink has left the room, we should too
+        if (node_->sink_state() == NodeState::END)
+            break;
+
+        if (boost::get_system_time() >= deadline)
+            return false;
+
+        timeout = std::min(deadline, boost::get_system_time() + msec_t(10));
+    }
+
+    did_wait_need_post_ = true;
+    state = node_->sink_state();
+
+    return true;
+}
+
 template<typename T>
 inline void SourceBase<T>::post() {
 
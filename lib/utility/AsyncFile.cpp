@@ -0,0 +1,202 @@
+//******************************************************************************
+//* File:   AsyncFile.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#include "AsyncFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace oat {
+
+AsyncFile::AsyncFile(const std::string &path,
+                     const size_t block_bytes,
+                     const size_t blocks,
+                     const size_t writers) :
+  path_(path)
+, block_bytes_(block_bytes)
+, blocks_(blocks < 2 ? 2 : blocks)
+{
+    if (block_bytes_ == 0)
+        throw std::runtime_error("Asynchronous file blocks must not be empty.");
+
+    // Blocks are written through the page cache. O_DIRECT is not used
+    // because flushed blocks end, and the next ones start, at arbitrary
+    // offsets.
+    for (auto &b : blocks_) {
+        b.data = static_cast<char *>(malloc(block_bytes_));
+        if (b.data == nullptr) {
+            for (auto &a : blocks_)
+                free(a.data);
+            throw std::runtime_error("Could not allocate buffers for " + path_);
+        }
+    }
+
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        for (auto &b : blocks_)
+            free(b.data);
+        throw std::runtime_error("Could not open " + path_ + " for writing.");
+    }
+
+    current_ = &blocks_[0];
+    for (size_t i = 1; i < blocks_.size(); i++)
+        free_.push_back(&blocks_[i]);
+
+    // At least one block is always left for the caller to fill
+    const size_t n = std::max<size_t>(1, std::min(writers, blocks_.size() - 1));
+    for (size_t i = 0; i < n; i++)
+        io_threads_.push_back(std::thread( [this] { ioLoop(); } ));
+}
+
+AsyncFile::~AsyncFile() {
+
+    try {
+        flush();
+    } catch (const std::runtime_error &) {
+        // Nothing more can be done
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    for (auto &t : io_threads_)
+        t.join();
+
+    close(fd_);
+
+    for (auto &b : blocks_)
+        free(b.data);
+}
+
+void AsyncFile::append(const char *data, size_t n) {
+
+    while (n > 0) {
+
+        if (used_ == block_bytes_)
+            submit();
+
+        size_t k = std::min(n, block_bytes_ - used_);
+        std::memcpy(current_->data + used_, data, k);
+        used_ += k;
+        data += k;
+        n -= k;
+    }
+}
+
+void AsyncFile::flush() {
+
+    if (used_ > 0) {
+        submit();
+    } else {
+        std::lock_guard<std::mutex> lk(mutex_);
+        checkError();
+    }
+}
+
+void AsyncFile::sync() {
+
+    flush();
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return in_flight_ == 0 || error_; });
+    checkError();
+}
+
+void AsyncFile::submit() {
+
+    current_->offset = offset_;
+    current_->bytes = used_;
+    offset_ += used_;
+    used_ = 0;
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    checkError();
+
+    submitted_.push_back(current_);
+    in_flight_++;
+    cv_.notify_all();
+
+    // Only waits if the disk has fallen behind by every block
+    cv_.wait(lk, [this] { return !free_.empty() || error_; });
+    checkError();
+
+    current_ = free_.front();
+    free_.pop_front();
+}
+
+void AsyncFile::checkError() {
+
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void AsyncFile::ioLoop() {
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    while (true) {
+
+        cv_.wait(lk, [this] { return !submitted_.empty() || !running_; });
+
+        // Submitted blocks are always written before exiting
+        if (submitted_.empty())
+            return;
+
+        Block *b = submitted_.front();
+        submitted_.pop_front();
+        lk.unlock();
+
+        const char *data = b->data;
+        size_t n = b->bytes;
+        off_t offset = b->offset;
+        std::exception_ptr error;
+
+        while (n > 0) {
+            ssize_t rc = pwrite(fd_, data, n, offset);
+            if (rc < 0) {
+                if (errno == EINTR)
+                    continue;
+                error = std::make_exception_ptr(std::runtime_error(
+                    "Could not write to " + path_ + ": "
+                    + std::string(strerror(errno))));
+                break;
+            }
+            data += rc;
+            offset += rc;
+            n -= rc;
+        }
+
+        lk.lock();
+        if (error && !error_)
+            error_ = error;
+        free_.push_back(b);
+        in_flight_--;
+        cv_.notify_all();
+    }
+}
+
+} /* namespace oat */
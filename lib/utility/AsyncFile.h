@@ -0,0 +1,180 @@
+//******************************************************************************
+//* File:   AsyncFile.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_ASYNCFILE_H
+#define OAT_ASYNCFILE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+// Constants
+static constexpr size_t ASYNC_FILE_BLOCK_BYTES {1 << 20};
+static constexpr size_t ASYNC_FILE_BLOCKS {4};
+static constexpr size_t ASYNC_FILE_WRITERS {2};
+
+/**
+ * Append-only file written in the background. Data is copied into one of a
+ * fixed number of preallocated blocks. Full blocks, and partially filled
+ * blocks passed to flush, are submitted to a small pool of I/O threads that
+ * write them at their file offset using pwrite(2), so that the caller does
+ * not wait on the disk. With more than one I/O thread, several writes are
+ * outstanding at once and may complete out of order, so a reader, or a file
+ * left by a crash, can see a gap before the last block written. Files that
+ * must grow strictly in order use a single I/O thread. The caller only waits
+ * if every block is waiting to be written.
+ *
+ * Errors on the I/O thread are rethrown as std::runtime_error on the next
+ * call to append, put, flush or sync.
+ */
+class AsyncFile {
+
+public:
+
+    /**
+     * @brief Create, or truncate, a file for asynchronous writing.
+     * @param path File path.
+     * @param block_bytes Size of each block.
+     * @param blocks Number of blocks. At least two.
+     * @param writers Number of I/O threads, and so of writes in flight. At
+     * least one and fewer than blocks.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    AsyncFile(const std::string &path,
+              const size_t block_bytes = ASYNC_FILE_BLOCK_BYTES,
+              const size_t blocks = ASYNC_FILE_BLOCKS,
+              const size_t writers = ASYNC_FILE_WRITERS);
+
+    /**
+     * @brief Write all data that has been appended and close the file.
+     */
+    ~AsyncFile();
+
+    // Files are not copyable
+    AsyncFile(const AsyncFile &) = delete;
+    AsyncFile & operator=(const AsyncFile &) = delete;
+
+    /**
+     * @brief Append data to the file.
+     * @param data Data to append.
+     * @param n Number of bytes.
+     */
+    void append(const char *data, size_t n);
+
+    /**
+     * @brief Append a single character to the file.
+     */
+    void put(const char c) {
+        if (used_ == block_bytes_)
+            submit();
+        current_->data[used_++] = c;
+    }
+
+    /**
+     * @brief Submit appended data for writing without waiting for it to be
+     * written.
+     */
+    void flush(void);
+
+    /**
+     * @brief Submit appended data and wait until it has been written.
+     */
+    void sync(void);
+
+    /**
+     * @brief Number of bytes that can be appended before the current block
+     * is submitted.
+     */
+    size_t available(void) const { return block_bytes_ - used_; }
+
+    /**
+     * @brief Number of bytes appended so far.
+     */
+    uint64_t size(void) const { return offset_ + used_; }
+
+    const std::string & path(void) const { return path_; }
+
+private:
+
+    struct Block {
+        char *data {nullptr};
+        uint64_t offset {0};
+        size_t bytes {0};
+    };
+
+    const std::string path_;
+    const size_t block_bytes_;
+    int fd_ {-1};
+
+    // Preallocated blocks. current_ is being filled by the caller.
+    std::vector<Block> blocks_;
+    Block *current_ {nullptr};
+    size_t used_ {0};
+    uint64_t offset_ {0};
+
+    // Blocks shared with the I/O thread, guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Block *> free_;
+    std::deque<Block *> submitted_;
+    size_t in_flight_ {0};
+    bool running_ {true};
+    std::exception_ptr error_;
+
+    std::vector<std::thread> io_threads_;
+
+    // Pass current_ to the I/O thread and take a free block
+    void submit(void);
+
+    // Rethrow an I/O thread error. mutex_ must be held.
+    void checkError(void);
+
+    // Executed by each of io_threads_
+    void ioLoop(void);
+};
+
+/**
+ * rapidjson output stream writing to an oat::AsyncFile.
+ */
+class AsyncFileStream {
+
+public:
+
+    typedef char Ch;
+
+    explicit AsyncFileStream(oat::AsyncFile &file) : file_(file) { }
+
+    void Put(char c) { file_.put(c); }
+    void Flush() { }
+
+private:
+
+    oat::AsyncFile &file_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_ASYNCFILE_H */
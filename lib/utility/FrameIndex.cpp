@@ -0,0 +1,80 @@
+//******************************************************************************
+//* File:   FrameIndex.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "FrameIndex.h"
+
+namespace oat {
+namespace frameidx {
+
+void initializeHeader(Header &header,
+                      const std::string &source,
+                      const double sample_rate_hz,
+                      const uint32_t fields,
+                      const std::string &oat_version,
+                      const std::string &date) {
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.header_bytes = sizeof(Header);
+    header.record_bytes = sizeof(Record);
+    header.fields = fields & (OFFSET | KEYFRAME);
+    header.sample_rate_hz = std::isfinite(sample_rate_hz) ? sample_rate_hz : -1.0;
+
+    strncpy(header.oat_version, oat_version.c_str(), sizeof(header.oat_version) - 1);
+    strncpy(header.date, date.c_str(), sizeof(header.date) - 1);
+    strncpy(header.source, source.c_str(), sizeof(header.source) - 1);
+}
+
+// Headers are read through MappedRecordFile
+static_assert(offsetof(Header, record_bytes) == offsetof(RecordFileHeader, record_bytes),
+              "Frame index header must start with a RecordFileHeader.");
+
+Reader::Reader(const std::string &path) :
+  file_(path, "frame index", MAGIC, VERSION, sizeof(Header), alignof(Record))
+{
+    // Records are read in place
+    if (header().record_bytes != sizeof(Record))
+        throw std::runtime_error(path + " is not a valid frame index.");
+}
+
+const Record & Reader::record(const size_t index) const {
+
+    return *reinterpret_cast<const Record *>(file_.data(index));
+}
+
+size_t Reader::find(const uint64_t tick) const {
+
+    // Frames are recorded in sample order
+    const Record *records = size() > 0 ? &record(0) : nullptr;
+    auto it = std::lower_bound(records, records + size(), tick,
+        [](const Record &r, const uint64_t t) { return r.tick < t; });
+
+    return it - records;
+}
+
+}      /* namespace frameidx */
+}      /* namespace oat */
@@ -0,0 +1,153 @@
+//******************************************************************************
+//* File:   FrameIndex.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_FRAMEINDEX_H
+#define OAT_FRAMEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedRecordFile.h"
+
+namespace oat {
+namespace frameidx {
+
+/**
+ * Binary video frame index format.
+ *
+ * A frame index is written next to each recorded video. It is a fixed size
+ * Header followed by a packed array of fixed size records, one per encoded
+ * video frame and in the same order. All values are stored in host byte
+ * order. Each record holds the sample number and time of the frame, so that
+ * video frames can be joined with position logs without decoding the video,
+ * and so that the video frame holding a given sample can be found by binary
+ * search. A partially written file remains readable up to its last complete
+ * record.
+ */
+
+static constexpr char MAGIC[8] {'O', 'A', 'T', 'F', 'I', 'D', 'X', '\0'};
+static constexpr uint32_t VERSION {1};
+
+/**
+ * Optional record fields. Writers that cannot determine these, e.g. because
+ * the encoder does not expose them, leave them out of Header::fields.
+ */
+enum Field : uint32_t {
+    OFFSET   = 1 << 0,  //!< Record::offset is known
+    KEYFRAME = 1 << 1   //!< Record::flags contains KEY_FRAME
+};
+
+/**
+ * Per-record flags.
+ */
+enum Flag : uint32_t {
+    KEY_FRAME = 1 << 0  //!< Frame can be decoded on its own
+};
+
+/**
+ * Self-describing file header.
+ */
+struct Header {
+    char magic[8];              //!< Always MAGIC
+    uint32_t version;           //!< Format version
+    uint32_t header_bytes;      //!< Offset of the first record
+    uint32_t record_bytes;      //!< Size of each record
+    uint32_t fields;            //!< Bitmask of Field values that are known
+    double sample_rate_hz;      //!< Source sample rate, -1 if unknown
+    char oat_version[64];       //!< Oat version that wrote the file
+    char date[32];              //!< Recording timestamp
+    char source[104];           //!< Frame SOURCE name
+};
+
+/**
+ * Index record.
+ */
+struct Record {
+    uint64_t tick {0};      //!< Sample number
+    int64_t usec {0};       //!< Sample time, microseconds
+    uint64_t frame {0};     //!< Index of the frame in the video
+    int64_t offset {-1};    //!< Byte offset of the encoded frame, -1 if unknown
+    uint32_t flags {0};     //!< Flag values
+    uint32_t reserved {0};
+};
+
+static_assert(sizeof(Record) == 40, "Frame index records must be packed.");
+
+/**
+ * @brief Fill a file header.
+ * @param header Header to fill.
+ * @param source Frame SOURCE name.
+ * @param sample_rate_hz Source sample rate. Non-finite values are stored as -1.
+ * @param fields Bitmask of Field values that records will contain.
+ * @param oat_version Oat version string.
+ * @param date Recording timestamp.
+ */
+void initializeHeader(Header &header,
+                      const std::string &source,
+                      const double sample_rate_hz,
+                      const uint32_t fields,
+                      const std::string &oat_version,
+                      const std::string &date);
+
+/**
+ * Memory mapped, read-only frame index.
+ */
+class Reader {
+
+public:
+
+    /**
+     * @brief Map a frame index into memory.
+     * @param path Path to the frame index.
+     * @throws std::runtime_error if the file cannot be mapped or does not
+     * contain a valid header.
+     */
+    explicit Reader(const std::string &path);
+
+    const Header & header() const {
+        return *reinterpret_cast<const Header *>(file_.header());
+    }
+
+    /**
+     * @brief Number of complete records in the file.
+     */
+    size_t size() const { return file_.size(); }
+
+    /**
+     * @brief Get a record.
+     * @param index Record index.
+     */
+    const Record & record(const size_t index) const;
+
+    /**
+     * @brief Find the first frame recorded at or after a sample.
+     * @param tick Sample number.
+     * @return Record index, or size() if all frames precede the sample.
+     */
+    size_t find(const uint64_t tick) const;
+
+private:
+
+    oat::MappedRecordFile file_;
+};
+
+}      /* namespace frameidx */
+}      /* namespace oat */
+#endif /* OAT_FRAMEINDEX_H */
@@ -0,0 +1,90 @@
+//******************************************************************************
+//* File:   MappedRecordFile.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedRecordFile.h"
+
+namespace oat {
+
+MappedRecordFile::MappedRecordFile(const std::string &path,
+                                   const std::string &kind,
+                                   const char (&magic)[8],
+                                   const uint32_t version,
+                                   const size_t min_header_bytes,
+                                   const size_t record_align) :
+  kind_(kind)
+{
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        throw std::runtime_error("Could not open " + kind_ + " " + path);
+
+    struct stat st;
+    if (fstat(fd_, &st) < 0 || static_cast<size_t>(st.st_size) < min_header_bytes) {
+        close(fd_);
+        throw std::runtime_error(path + " is not a " + kind_ + ".");
+    }
+
+    bytes_ = st.st_size;
+    void *map = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        close(fd_);
+        throw std::runtime_error("Could not map " + kind_ + " " + path);
+    }
+
+    map_ = static_cast<const char *>(map);
+    const RecordFileHeader &h = common();
+
+    // Records may be read in place, so the header size must keep them aligned
+    if (std::memcmp(h.magic, magic, sizeof(h.magic)) != 0 ||
+        h.version != version ||
+        h.header_bytes < min_header_bytes ||
+        h.header_bytes > bytes_ ||
+        h.header_bytes % record_align != 0 ||
+        h.record_bytes == 0) {
+        munmap(const_cast<char *>(map_), bytes_);
+        close(fd_);
+        throw std::runtime_error(path + " is not a valid " + kind_ + ".");
+    }
+
+    size_ = (bytes_ - h.header_bytes) / h.record_bytes;
+}
+
+MappedRecordFile::~MappedRecordFile() {
+
+    munmap(const_cast<char *>(map_), bytes_);
+    close(fd_);
+}
+
+const char * MappedRecordFile::data(const size_t index) const {
+
+    if (index >= size_)
+        throw std::out_of_range("Record index out of range in " + kind_ + ".");
+
+    return map_ + common().header_bytes + index * common().record_bytes;
+}
+
+}      /* namespace oat */
@@ -0,0 +1,105 @@
+//******************************************************************************
+//* File:   MappedRecordFile.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_MAPPEDRECORDFILE_H
+#define OAT_MAPPEDRECORDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace oat {
+
+/**
+ * Leading fields shared by the headers of fixed size record files (see
+ * oat::poslog and oat::frameidx).
+ */
+struct RecordFileHeader {
+    char magic[8];              //!< Format identifier
+    uint32_t version;           //!< Format version
+    uint32_t header_bytes;      //!< Offset of the first record
+    uint32_t record_bytes;      //!< Size of each record
+};
+
+/**
+ * Memory mapped, read-only file consisting of a header that starts with a
+ * RecordFileHeader followed by a packed array of fixed size records. A
+ * partially written file is readable up to its last complete record.
+ */
+class MappedRecordFile {
+
+public:
+
+    /**
+     * @brief Map a record file into memory and check its leading header
+     * fields.
+     * @param path Path to the file.
+     * @param kind Name of the format, used in error messages.
+     * @param magic Expected format identifier.
+     * @param version Expected format version.
+     * @param min_header_bytes Size of the format's header.
+     * @param record_align Required alignment of the first record.
+     * @throws std::runtime_error if the file cannot be mapped or its header
+     * does not match.
+     */
+    MappedRecordFile(const std::string &path,
+                     const std::string &kind,
+                     const char (&magic)[8],
+                     const uint32_t version,
+                     const size_t min_header_bytes,
+                     const size_t record_align = 1);
+
+    ~MappedRecordFile();
+
+    // Mapped files are not copyable
+    MappedRecordFile(const MappedRecordFile &) = delete;
+    MappedRecordFile & operator=(const MappedRecordFile &) = delete;
+
+    /**
+     * @brief Start of the file, i.e. the format's header.
+     */
+    const char * header() const { return map_; }
+
+    const RecordFileHeader & common() const {
+        return *reinterpret_cast<const RecordFileHeader *>(map_);
+    }
+
+    /**
+     * @brief Number of complete records in the file.
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Pointer to the raw bytes of a record.
+     * @param index Record index.
+     * @throws std::out_of_range if index is not less than size().
+     */
+    const char * data(const size_t index) const;
+
+private:
+
+    const std::string kind_;
+    int fd_ {-1};
+    size_t bytes_ {0};
+    const char * map_ {nullptr};
+    size_t size_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_MAPPEDRECORDFILE_H */
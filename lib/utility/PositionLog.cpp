@@ -0,0 +1,171 @@
+//******************************************************************************
+//* File:   PositionLog.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "PositionLog.h"
+
+namespace oat {
+namespace poslog {
+
+// Columns in the order they appear in a record
+static constexpr Column column_order[] {POSITION, VELOCITY, HEADING, REGION};
+
+static size_t columnBytes(const Column column) {
+
+    return column == REGION ? REGION_COLUMN_BYTES : VECTOR_COLUMN_BYTES;
+}
+
+size_t recordBytes(const uint32_t columns) {
+
+    size_t bytes = RECORD_BASE_BYTES;
+    for (auto c : column_order)
+        if (columns & c)
+            bytes += columnBytes(c);
+
+    return bytes;
+}
+
+std::ptrdiff_t columnOffset(const uint32_t columns, const Column column) {
+
+    if (!(columns & column))
+        return -1;
+
+    std::ptrdiff_t offset = RECORD_BASE_BYTES;
+    for (auto c : column_order) {
+        if (c == column)
+            break;
+        if (columns & c)
+            offset += columnBytes(c);
+    }
+
+    return offset;
+}
+
+void initializeHeader(Header &header,
+                      const std::string &source,
+                      const double sample_rate_hz,
+                      const uint32_t columns,
+                      const std::string &oat_version,
+                      const std::string &date) {
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.header_bytes = sizeof(Header);
+    header.record_bytes = recordBytes(columns);
+    header.columns = columns & ALL;
+    header.sample_rate_hz = std::isfinite(sample_rate_hz) ? sample_rate_hz : -1.0;
+
+    strncpy(header.oat_version, oat_version.c_str(), sizeof(header.oat_version) - 1);
+    strncpy(header.date, date.c_str(), sizeof(header.date) - 1);
+    strncpy(header.source, source.c_str(), sizeof(header.source) - 1);
+}
+
+void packRecord(const Record &record, const uint32_t columns, char *out) {
+
+    std::memset(out, 0, RECORD_BASE_BYTES);
+    std::memcpy(out, &record.tick, sizeof(record.tick));
+    std::memcpy(out + 8, &record.usec, sizeof(record.usec));
+    std::memcpy(out + 16, &record.unit, sizeof(record.unit));
+    std::memcpy(out + 20, &record.flags, sizeof(record.flags));
+
+    char *col = out + RECORD_BASE_BYTES;
+
+    if (columns & POSITION) {
+        std::memcpy(col, record.position, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & VELOCITY) {
+        std::memcpy(col, record.velocity, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & HEADING) {
+        std::memcpy(col, record.heading, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & REGION) {
+        std::memcpy(col, record.region, REGION_COLUMN_BYTES);
+        col[REGION_COLUMN_BYTES - 1] = '\0';
+    }
+}
+
+void unpackRecord(const char *in, const uint32_t columns, Record &record) {
+
+    record = Record();
+    std::memcpy(&record.tick, in, sizeof(record.tick));
+    std::memcpy(&record.usec, in + 8, sizeof(record.usec));
+    std::memcpy(&record.unit, in + 16, sizeof(record.unit));
+    std::memcpy(&record.flags, in + 20, sizeof(record.flags));
+
+    const char *col = in + RECORD_BASE_BYTES;
+
+    if (columns & POSITION) {
+        std::memcpy(record.position, col, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & VELOCITY) {
+        std::memcpy(record.velocity, col, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & HEADING) {
+        std::memcpy(record.heading, col, VECTOR_COLUMN_BYTES);
+        col += VECTOR_COLUMN_BYTES;
+    }
+
+    if (columns & REGION) {
+        std::memcpy(record.region, col, REGION_COLUMN_BYTES);
+        record.region[REGION_COLUMN_BYTES - 1] = '\0';
+    }
+}
+
+// Headers are read through MappedRecordFile
+static_assert(offsetof(Header, record_bytes) == offsetof(RecordFileHeader, record_bytes),
+              "Position log header must start with a RecordFileHeader.");
+
+Reader::Reader(const std::string &path) :
+  file_(path, "position log", MAGIC, VERSION, sizeof(Header))
+{
+    if (header().record_bytes != recordBytes(header().columns))
+        throw std::runtime_error(path + " is not a valid position log.");
+}
+
+const char * Reader::data(const size_t index) const {
+
+    return file_.data(index);
+}
+
+Record Reader::record(const size_t index) const {
+
+    Record r;
+    unpackRecord(data(index), header().columns, r);
+    return r;
+}
+
+}      /* namespace poslog */
+}      /* namespace oat */
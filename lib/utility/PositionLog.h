@@ -0,0 +1,201 @@
+//******************************************************************************
+//* File:   PositionLog.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_POSITIONLOG_H
+#define OAT_POSITIONLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedRecordFile.h"
+
+namespace oat {
+namespace poslog {
+
+/**
+ * Binary position log format.
+ *
+ * A position log is a fixed size Header followed by a packed array of fixed
+ * size records, one per sample. All values are stored in host byte order.
+ * Because every record has the same size, the number of samples in a file is
+ * (file_size - header_bytes) / record_bytes and a partially written file
+ * remains readable up to its last complete record. Each record starts with
+ * the sample number, sample time, length unit and validity flags. The
+ * remaining columns (position, velocity, heading, region) are optional and
+ * are specified by the columns bitmask in the header. Columns appear in the
+ * order they are declared in Column.
+ */
+
+static constexpr char MAGIC[8] {'O', 'A', 'T', 'P', 'O', 'S', '\0', '\0'};
+static constexpr uint32_t VERSION {1};
+
+// Size of the fixed part of each record: tick, usec, unit, flags, padding
+static constexpr size_t RECORD_BASE_BYTES {24};
+
+// Size of a 2D vector column
+static constexpr size_t VECTOR_COLUMN_BYTES {2 * sizeof(double)};
+
+// Size of the region column. oat::Position::region is 100 bytes. Padded to
+// keep records 8-byte aligned.
+static constexpr size_t REGION_COLUMN_BYTES {104};
+
+/**
+ * Optional record columns.
+ */
+enum Column : uint32_t {
+    POSITION = 1 << 0,
+    VELOCITY = 1 << 1,
+    HEADING  = 1 << 2,
+    REGION   = 1 << 3,
+    ALL      = POSITION | VELOCITY | HEADING | REGION
+};
+
+/**
+ * Per-record validity flags.
+ */
+enum Flag : uint8_t {
+    POSITION_VALID = 1 << 0,
+    VELOCITY_VALID = 1 << 1,
+    HEADING_VALID  = 1 << 2,
+    REGION_VALID   = 1 << 3,
+    POSITION_HELD  = 1 << 4
+};
+
+/**
+ * Self-describing file header.
+ */
+struct Header {
+    char magic[8];              //!< Always MAGIC
+    uint32_t version;           //!< Format version
+    uint32_t header_bytes;      //!< Offset of the first record
+    uint32_t record_bytes;      //!< Size of each record
+    uint32_t columns;           //!< Bitmask of Column values present
+    double sample_rate_hz;      //!< Source sample rate, -1 if unknown
+    char oat_version[64];       //!< Oat version that wrote the file
+    char date[32];              //!< Recording timestamp
+    char source[104];           //!< Position SOURCE name
+};
+
+/**
+ * Decoded position record. Fields for columns that are not present in a file
+ * are zeroed.
+ */
+struct Record {
+    uint64_t tick {0};
+    int64_t usec {0};
+    int32_t unit {0};
+    uint8_t flags {0};
+    double position[2] {0.0, 0.0};
+    double velocity[2] {0.0, 0.0};
+    double heading[2] {0.0, 0.0};
+    char region[REGION_COLUMN_BYTES] {0};
+};
+
+/**
+ * @brief Size of a record containing the specified columns.
+ * @param columns Bitmask of Column values.
+ * @return Record size in bytes.
+ */
+size_t recordBytes(const uint32_t columns);
+
+/**
+ * @brief Byte offset of a column within a record.
+ * @param columns Bitmask of Column values present in the record.
+ * @param column Column to locate.
+ * @return Offset in bytes or -1 if the column is not present.
+ */
+std::ptrdiff_t columnOffset(const uint32_t columns, const Column column);
+
+/**
+ * @brief Fill a file header.
+ * @param header Header to fill.
+ * @param source Position SOURCE name.
+ * @param sample_rate_hz Source sample rate. Non-finite values are stored as -1.
+ * @param columns Bitmask of Column values that records will contain.
+ * @param oat_version Oat version string.
+ * @param date Recording timestamp.
+ */
+void initializeHeader(Header &header,
+                      const std::string &source,
+                      const double sample_rate_hz,
+                      const uint32_t columns,
+                      const std::string &oat_version,
+                      const std::string &date);
+
+/**
+ * @brief Pack a record into its binary representation.
+ * @param record Record to pack.
+ * @param columns Bitmask of Column values to write.
+ * @param out Output buffer of at least recordBytes(columns) bytes.
+ */
+void packRecord(const Record &record, const uint32_t columns, char *out);
+
+/**
+ * @brief Unpack a binary record.
+ * @param in Input buffer of at least recordBytes(columns) bytes.
+ * @param columns Bitmask of Column values present in the buffer.
+ * @param record Decoded record.
+ */
+void unpackRecord(const char *in, const uint32_t columns, Record &record);
+
+/**
+ * Memory mapped, read-only position log.
+ */
+class Reader {
+
+public:
+
+    /**
+     * @brief Map a position log into memory.
+     * @param path Path to the position log.
+     * @throws std::runtime_error if the file cannot be mapped or does not
+     * contain a valid header.
+     */
+    explicit Reader(const std::string &path);
+
+    const Header & header() const {
+        return *reinterpret_cast<const Header *>(file_.header());
+    }
+
+    /**
+     * @brief Number of complete records in the file.
+     */
+    size_t size() const { return file_.size(); }
+
+    /**
+     * @brief Pointer to the raw bytes of a record.
+     * @param index Record index.
+     */
+    const char * data(const size_t index) const;
+
+    /**
+     * @brief Decode a record.
+     * @param index Record index.
+     */
+    Record record(const size_t index) const;
+
+private:
+
+    oat::MappedRecordFile file_;
+};
+
+}      /* namespace poslog */
+}      /* namespace oat */
+#endif /* OAT_POSITIONLOG_H */
@@ -0,0 +1,101 @@
+//******************************************************************************
+//* File:   TripleBuffer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_TRIPLEBUFFER_H
+#define OAT_TRIPLEBUFFER_H
+
+#include <atomic>
+
+namespace oat {
+
+/**
+ * Lock-free handoff of the latest value of T from one producer thread to one
+ * consumer thread. The producer fills back() and publishes it. The consumer
+ * calls update() to take the most recently published value, if there is a
+ * new one, and reads it through front(). Neither thread ever waits, values
+ * that are published faster than they are taken are replaced, and the
+ * three slots are reused, so that T can hold preallocated buffers.
+ */
+template <typename T>
+class TripleBuffer {
+
+public:
+
+    TripleBuffer() = default;
+
+    /**
+     * @brief Triple buffer with all slots initialized to a value.
+     */
+    explicit TripleBuffer(const T &value) :
+      slots_ {value, value, value}
+    {
+        // Nothing
+    }
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+    /**
+     * @brief Slot to be filled by the producer. Producer thread only.
+     */
+    T & back(void) { return slots_[back_]; }
+
+    /**
+     * @brief Hand back() to the consumer. back() then refers to a slot the
+     * consumer is not using. Producer thread only.
+     */
+    void publish(void) {
+        back_ = state_.exchange(back_ | FRESH) & INDEX;
+    }
+
+    /**
+     * @brief Take the most recently published value. Consumer thread only.
+     * @return True if a value was published since the last update.
+     */
+    bool update(void) {
+
+        if (!(state_.load() & FRESH))
+            return false;
+
+        front_ = state_.exchange(front_) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Value taken by the last update. Consumer thread only.
+     */
+    T & front(void) { return slots_[front_]; }
+    const T & front(void) const { return slots_[front_]; }
+
+private:
+
+    static constexpr int INDEX {3};
+    static constexpr int FRESH {4};
+
+    T slots_[3];
+
+    // Slot owned by each thread. The slot in between, and whether it holds
+    // a value that has not been taken, is exchanged atomically.
+    int back_ {0};
+    int front_ {1};
+    std::atomic<int> state_ {2};
+};
+
+}      /* namespace oat */
+#endif /* OAT_TRIPLEBUFFER_H */
@@ -0,0 +1,159 @@
+//******************************************************************************
+//* File:   TuningWindow.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#include "TuningWindow.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace oat {
+
+// Constant definitions
+constexpr std::chrono::milliseconds TuningWindow::MIN_UPDATE_PERIOD_MS;
+
+TuningWindow::TuningWindow(const std::string &title) :
+  title_(title)
+{
+    // Nothing
+}
+
+TuningWindow::~TuningWindow() {
+
+    running_ = false;
+    if (gui_thread_.joinable())
+        gui_thread_.join();
+}
+
+size_t TuningWindow::addSlider(const std::string &name,
+                               const int value,
+                               const int max) {
+
+    if (running_ || sliders_.size() == MAX_TUNING_SLIDERS)
+        throw std::runtime_error("Cannot add tuning slider " + name + ".");
+
+    sliders_.push_back(Slider {name, value, max});
+
+    // Initial values are visible to the tuned thread before any update
+    initial_.v[sliders_.size() - 1] = value;
+    values_.back() = initial_;
+    values_.publish();
+    values_.update();
+
+    return sliders_.size() - 1;
+}
+
+void TuningWindow::start() {
+
+    if (running_)
+        return;
+
+    running_ = true;
+    gui_thread_ = std::thread(&TuningWindow::run, this);
+}
+
+TuningWindow::Snapshot * TuningWindow::snapshot() {
+
+    if (!running_)
+        return nullptr;
+
+    const auto now = Clock::now();
+    if (now - last_snapshot_ < MIN_UPDATE_PERIOD_MS)
+        return nullptr;
+
+    last_snapshot_ = now;
+    return &snapshots_.back();
+}
+
+void TuningWindow::run() {
+
+    // Windows, sliders and events all belong to this thread
+    cv::namedWindow(title_, cv::WINDOW_NORMAL);
+    for (auto &s : sliders_)
+        cv::createTrackbar(s.name, title_, &s.value, s.max);
+
+    Values last = initial_;
+
+    while (running_) {
+
+        if (snapshots_.update())
+            draw(snapshots_.front());
+
+        // Handles slider events and limits the refresh rate
+        const int key = cv::waitKey(MIN_UPDATE_PERIOD_MS.count());
+
+        // Hand changed slider values back as a complete set
+        bool changed = false;
+        for (size_t i = 0; i < sliders_.size(); i++) {
+            changed |= last.v[i] != sliders_[i].value;
+            last.v[i] = sliders_[i].value;
+        }
+
+        if (changed) {
+            values_.back() = last;
+            values_.publish();
+        }
+
+        if ((key & 0xFF) == 27)
+            running_ = false;
+    }
+
+    cv::destroyWindow(title_);
+}
+
+void TuningWindow::draw(const Snapshot &s) {
+
+    if (s.frame.empty())
+        return;
+
+    if (s.mask.empty()) {
+        s.frame.copyTo(canvas_);
+    } else {
+        canvas_.create(s.frame.size(), s.frame.type());
+        canvas_.setTo(0);
+        s.frame.copyTo(canvas_, s.mask);
+    }
+
+    std::string msg = "Object not found";
+
+    // Plot a circle representing found object
+    if (s.position_valid) {
+        const double radius = std::sqrt(s.area / CV_PI);
+        cv::circle(canvas_,
+                   cv::Point(s.position.x, s.position.y),
+                   radius,
+                   cv::Scalar(0, 0, 255),
+                   4);
+        msg = cv::format("(%d, %d) pixels",
+                         static_cast<int>(s.position.x),
+                         static_cast<int>(s.position.y));
+    }
+
+    int baseline = 0;
+    cv::Size text_size = cv::getTextSize(msg, 1, 1, 1, &baseline);
+    cv::Point text_origin(canvas_.cols - text_size.width - 10,
+                          canvas_.rows - 2 * baseline - 10);
+
+    cv::putText(canvas_, msg, text_origin, 1, 1, cv::Scalar(0, 255, 0));
+
+    cv::imshow(title_, canvas_);
+}
+
+}      /* namespace oat */
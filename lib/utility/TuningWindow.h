@@ -0,0 +1,146 @@
+//******************************************************************************
+//* File:   TuningWindow.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_TUNINGWINDOW_H
+#define OAT_TUNINGWINDOW_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "TripleBuffer.h"
+
+namespace oat {
+
+// Constants
+static constexpr size_t MAX_TUNING_SLIDERS {16};
+
+/**
+ * Parameter tuning window with sliders and an optional image, run by its own
+ * GUI thread so that drawing, display and event handling stay off the thread
+ * being tuned. Images are handed to the GUI thread, at most once per display
+ * period, and slider values are handed back, as a complete set, through
+ * lock-free triple buffers. Pressing ESC in the window closes it.
+ */
+class TuningWindow {
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    /**
+     * Image shown in the window, overlaid with the detected object.
+     */
+    struct Snapshot {
+        cv::Mat frame;          //!< BGR frame
+        cv::Mat mask;           //!< If not empty, only pixels set here are shown
+        cv::Point2d position;   //!< Object position (pixels)
+        bool position_valid {false};
+        double area {0.0};      //!< Object area (pixels^2), drawn as a circle
+    };
+
+    /**
+     * @brief Tuning window. The GUI thread is started by start().
+     * @param title Window title.
+     */
+    explicit TuningWindow(const std::string &title);
+
+    ~TuningWindow();
+
+    TuningWindow(const TuningWindow &) = delete;
+    TuningWindow & operator=(const TuningWindow &) = delete;
+
+    /**
+     * @brief Add a slider. Must be called before start().
+     * @param name Slider label.
+     * @param value Initial value.
+     * @param max Maximum value.
+     * @return Slider index to be used with value().
+     */
+    size_t addSlider(const std::string &name, const int value, const int max);
+
+    /**
+     * @brief Create the window and start the GUI thread.
+     */
+    void start(void);
+
+    /**
+     * @brief Take slider values changed since the last call.
+     * @return True if any value changed.
+     */
+    bool update(void) { return values_.update(); }
+
+    /**
+     * @brief Slider value as of the last update.
+     */
+    int value(const size_t i) const { return values_.front().v[i]; }
+
+    /**
+     * @brief Snapshot to be filled and then passed to show, if the window
+     * is due for a new image. Buffers are reused.
+     * @return Snapshot to fill, or nullptr if no image is needed yet.
+     */
+    Snapshot * snapshot(void);
+
+    /**
+     * @brief Hand the snapshot returned by snapshot() to the GUI thread.
+     */
+    void show(void) { snapshots_.publish(); }
+
+    /**
+     * @brief False once the user has closed the window.
+     */
+    bool open(void) const { return running_; }
+
+    // Minimum time between displayed images
+    static constexpr std::chrono::milliseconds MIN_UPDATE_PERIOD_MS {33};
+
+private:
+
+    struct Values {
+        int v[MAX_TUNING_SLIDERS] {};
+    };
+
+    struct Slider {
+        std::string name;
+        int value;  //!< Written by the slider on the GUI thread only
+        int max;
+    };
+
+    const std::string title_;
+    std::vector<Slider> sliders_;
+
+    Values initial_;
+    TripleBuffer<Values> values_;
+    TripleBuffer<Snapshot> snapshots_;
+    Clock::time_point last_snapshot_;
+
+    std::atomic<bool> running_ {false};
+    std::thread gui_thread_;
+    cv::Mat canvas_;
+
+    void run(void);
+    void draw(const Snapshot &s);
+};
+
+}      /* namespace oat */
+#endif /* OAT_TUNINGWINDOW_H */
@@ -0,0 +1,264 @@
+//******************************************************************************
+//* File:   oat posiconv main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/PositionLog.h"
+
+namespace po = boost::program_options;
+namespace bfs = boost::filesystem;
+
+// Constants
+static constexpr int JSON_WRITE_BUFFER_SIZE {65536};
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: posiconv [INFO]\n"
+              << "   or: posiconv SOURCE [DESTINATION] [CONFIGURATION]\n"
+              << "Convert a binary position file written by 'oat record "
+              << "--position-format binary' to the JSON position file format.\n\n"
+              << "SOURCE:\n"
+              << "  Path to binary position file.\n\n"
+              << "DESTINATION:\n"
+              << "  Path to JSON output file. Defaults to SOURCE with a .json "
+              << "extension.\n\n"
+              << options << "\n";
+}
+
+/**
+ * @brief Serialize a binary position record using the same fields as
+ * oat::Position2D::Serialize.
+ */
+template <typename Writer>
+void serializeRecord(Writer &writer,
+                     const oat::poslog::Record &r,
+                     const uint32_t columns,
+                     const bool verbose) {
+
+    bool pos_ok = r.flags & oat::poslog::POSITION_VALID;
+    bool vel_ok = r.flags & oat::poslog::VELOCITY_VALID;
+    bool head_ok = r.flags & oat::poslog::HEADING_VALID;
+    bool reg_ok = r.flags & oat::poslog::REGION_VALID;
+    bool pos_hold = r.flags & oat::poslog::POSITION_HELD;
+
+    writer.String("tick");
+    writer.Int(r.tick);
+
+    writer.String("usec");
+    writer.Int64(r.usec);
+
+    writer.String("unit");
+    writer.Int(r.unit);
+
+    writer.String("pos_ok");
+    writer.Bool(pos_ok || verbose);
+
+    if ((pos_ok || verbose) && (columns & oat::poslog::POSITION)) {
+        writer.String("pos_xy");
+        writer.StartArray();
+        writer.Double(r.position[0]);
+        writer.Double(r.position[1]);
+        writer.EndArray(2);
+    }
+
+    if (pos_hold) {
+        writer.String("pos_hold");
+        writer.Bool(true);
+    }
+
+    writer.String("vel_ok");
+    writer.Bool(vel_ok || verbose);
+
+    if ((vel_ok || verbose) && (columns & oat::poslog::VELOCITY)) {
+        writer.String("vel_xy");
+        writer.StartArray();
+        writer.Double(r.velocity[0]);
+        writer.Double(r.velocity[1]);
+        writer.EndArray(2);
+    }
+
+    writer.String("head_ok");
+    writer.Bool(head_ok);
+
+    if ((head_ok || verbose) && (columns & oat::poslog::HEADING)) {
+        writer.String("head_xy");
+        writer.StartArray();
+        writer.Double(r.heading[0]);
+        writer.Double(r.heading[1]);
+        writer.EndArray(2);
+    }
+
+    writer.String("reg_ok");
+    writer.Bool(reg_ok);
+
+    if ((reg_ok || verbose) && (columns & oat::poslog::REGION)) {
+        writer.String("reg");
+        writer.String(r.region);
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string source;
+    std::string destination;
+    bool concise_file = false;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description configuration("CONFIGURATION");
+        configuration.add_options()
+                ("concise-file,c",
+                 "If set, indeterminate position data fields will not be written "
+                 "e.g. pos_xy will not be written even when pos_ok = false.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("source", po::value<std::string>(&source),
+                 "Binary position file.")
+                ("destination", po::value<std::string>(&destination),
+                 "JSON output file.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("source", 1);
+        positional_options.add("destination", 1);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(configuration);
+
+        po::options_description all_options("ALL OPTIONS");
+        all_options.add(options).add(configuration).add(hidden);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Position Converter version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("source")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A SOURCE must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map.count("destination"))
+            destination = bfs::path(source).replace_extension(".json").string();
+
+        if (variable_map.count("concise-file"))
+            concise_file = true;
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    const std::string name = "posiconv[" + source + "->" + destination + "]";
+
+    try {
+
+        oat::poslog::Reader reader(source);
+        const oat::poslog::Header &h = reader.header();
+
+        FILE *fd = fopen(destination.c_str(), "wb");
+        if (fd == nullptr)
+            throw std::runtime_error("Could not open " + destination + " for writing.");
+
+        char buffer[JSON_WRITE_BUFFER_SIZE];
+        rapidjson::FileWriteStream stream(fd, buffer, sizeof(buffer));
+        rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(stream);
+
+        writer.StartObject();
+
+        writer.String("oat_version");
+        writer.String(h.oat_version);
+
+        writer.String("header");
+        writer.StartObject();
+        writer.String("date");
+        writer.String(h.date);
+        writer.String("sample_rate_hz");
+        writer.Double(h.sample_rate_hz);
+        writer.String("source");
+        writer.String(h.source);
+        writer.EndObject();
+
+        writer.String("positions");
+        writer.StartArray();
+
+        for (size_t i = 0; i < reader.size(); i++) {
+            writer.StartObject();
+            serializeRecord(writer, reader.record(i), h.columns, !concise_file);
+            writer.EndObject();
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+        stream.Flush();
+        fclose(fd);
+
+        std::cout << oat::whoMessage(name,
+                "Converted " + std::to_string(reader.size()) + " positions.\n");
+
+        return 0;
+
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError(name, "Unknown exception.\n");
+    }
+
+    // Exit failure
+    return -1;
+}
@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   BandParallel.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_BANDPARALLEL_H
+#define	OAT_BANDPARALLEL_H
+
+#include <algorithm>
+#include <opencv2/core.hpp>
+
+namespace oat {
+
+/**
+ * Adapts a callable with signature void(int band, const cv::Range &rows) to
+ * OpenCV's parallel loop body.
+ */
+template <typename F>
+class BandBody : public cv::ParallelLoopBody {
+
+public:
+
+    BandBody(const int rows, const int bands, F &f) :
+      rows_(rows)
+    , bands_(bands)
+    , f_(f)
+    {
+        // Nothing
+    }
+
+    void operator()(const cv::Range &range) const override {
+
+        for (int b = range.start; b < range.end; b++)
+            f_(b, cv::Range(rows_ * b / bands_, rows_ * (b + 1) / bands_));
+    }
+
+private:
+
+    const int rows_;
+    const int bands_;
+    F &f_;
+};
+
+/**
+ * @brief Split rows [0, rows) into horizontal bands of nearly equal height
+ * and process them in parallel on OpenCV's thread pool.
+ * @param rows Number of rows.
+ * @param bands Requested number of bands. Limited to the number of rows.
+ * @param f Callable with signature void(int band, const cv::Range &rows).
+ * Bands are processed concurrently, so f must only write to band specific
+ * state.
+ * @return Number of bands used.
+ */
+template <typename F>
+int parallelBands(const int rows, const int bands, F f) {
+
+    const int n = std::max(1, std::min(bands, rows));
+    BandBody<F> body(rows, n, f);
+
+    if (n == 1)
+        body(cv::Range(0, 1));
+    else
+        cv::parallel_for_(cv::Range(0, n), body, n);
+
+    return n;
+}
+
+/**
+ * @brief Resolve a configured band count, where 0 selects one band per
+ * OpenCV worker thread.
+ */
+inline int resolveBands(const int bands) {
+
+    return bands > 0 ? bands : std::max(1, cv::getNumThreads());
+}
+
+}       /* namespace oat */
+#endif	/* OAT_BANDPARALLEL_H */
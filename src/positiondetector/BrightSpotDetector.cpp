@@ -0,0 +1,344 @@
+//******************************************************************************
+//* File:   BrightSpotDetector.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/datatypes/Blobs2D.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "BrightSpotDetector.h"
+
+namespace oat {
+
+// Fixed point BGR to luma coefficients, as used by cv::cvtColor
+static constexpr int LUMA_SHIFT {14};
+static constexpr int LUMA_B {1868};
+static constexpr int LUMA_G {9617};
+static constexpr int LUMA_R {4899};
+
+static inline int luma(const uint8_t *p) {
+    return (LUMA_B * p[0] + LUMA_G * p[1] + LUMA_R * p[2]
+            + (1 << (LUMA_SHIFT - 1))) >> LUMA_SHIFT;
+}
+
+// Maximum of value(pixel) over each d x d block of frame. Blocks at the
+// right and bottom edges may be partial.
+template <typename F>
+static void maxPool(const cv::Mat &frame, cv::Mat &pooled, const int d, F value) {
+
+    const int cn = frame.channels();
+    pooled.setTo(0);
+
+    for (int y = 0; y < frame.rows; y++) {
+
+        const uint8_t *src = frame.ptr<uint8_t>(y);
+        uint8_t *dst = pooled.ptr<uint8_t>(y / d);
+
+        for (int bx = 0, x0 = 0; bx < pooled.cols; bx++, x0 += d) {
+
+            const int x1 = std::min(x0 + d, frame.cols);
+            int m = dst[bx];
+            for (int x = x0; x < x1; x++)
+                m = std::max(m, value(src + x * cn));
+            dst[bx] = static_cast<uint8_t>(m);
+        }
+    }
+}
+
+BrightSpotDetector::BrightSpotDetector(const std::string &frame_source_address,
+                                       const std::string &position_sink_address) :
+  PositionDetector(frame_source_address, position_sink_address)
+{
+    // Nothing
+}
+
+void BrightSpotDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
+
+    position.position_valid = false;
+
+    const cv::Mat roi = frame(search_roi_);
+    if (roi.empty())
+        return;
+
+    decimate(roi);
+    findPeaks();
+
+    // Refine peaks, brightest first. Peaks whose refined centroid falls
+    // within the window of an accepted spot belong to that spot.
+    spots_.clear();
+    double sum_x = 0, sum_y = 0, sum_w = 0;
+    const double min_separation = window_ / 2.0;
+
+    for (const auto &p : peaks_) {
+
+        if (spots_.size() == max_spots_)
+            break;
+
+        cv::Point2d c;
+        double weight, area;
+        cv::Rect region;
+        if (!refine(roi, p, c, weight, area, region))
+            continue;
+
+        bool duplicate = false;
+        for (const auto &s : spots_) {
+            if (std::abs(s.x - c.x) < min_separation &&
+                std::abs(s.y - c.y) < min_separation) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate)
+            continue;
+
+        spots_.push_back(c);
+        sum_x += weight * c.x;
+        sum_y += weight * c.y;
+        sum_w += weight;
+
+        if (blobs() != nullptr) {
+            Blob2D b;
+            b.centroid = cv::Point2d(c.x + search_roi_.x, c.y + search_roi_.y);
+            b.area = area;
+            b.bounding_box = cv::Rect(region.x + search_roi_.x,
+                                      region.y + search_roi_.y,
+                                      region.width,
+                                      region.height);
+            blobs()->insert(b);
+        }
+    }
+
+    if (spots_.empty())
+        return;
+
+    position.position.x = sum_x / sum_w + search_roi_.x;
+    position.position.y = sum_y / sum_w + search_roi_.y;
+    position.position_valid = true;
+}
+
+void BrightSpotDetector::decimate(const cv::Mat &roi) {
+
+    decimated_.create((roi.rows + decimate_ - 1) / decimate_,
+                      (roi.cols + decimate_ - 1) / decimate_,
+                      CV_8UC1);
+
+    // Choose the pixel value outside of the pixel loop
+    if (roi.channels() == 1) {
+        maxPool(roi, decimated_, decimate_, [](const uint8_t *p) -> int { return p[0]; });
+    } else if (channel_ < 0) {
+        maxPool(roi, decimated_, decimate_, luma);
+    } else {
+        const int c = channel_;
+        maxPool(roi, decimated_, decimate_, [c](const uint8_t *p) -> int { return p[c]; });
+    }
+}
+
+void BrightSpotDetector::findPeaks() {
+
+    peaks_.clear();
+
+    const int rows = decimated_.rows;
+    const int cols = decimated_.cols;
+
+    for (int y = 0; y < rows; y++) {
+
+        const uint8_t *row = decimated_.ptr<uint8_t>(y);
+
+        for (int x = 0; x < cols; x++) {
+
+            const int v = row[x];
+            if (v < threshold_)
+                continue;
+
+            // Plateaus yield a single peak: strictly greater than the
+            // neighbors already visited, at least equal to the rest
+            bool peak = true;
+            for (int dy = -1; dy <= 1 && peak; dy++) {
+
+                const int ny = y + dy;
+                if (ny < 0 || ny >= rows)
+                    continue;
+
+                const uint8_t *n = decimated_.ptr<uint8_t>(ny);
+                for (int dx = -1; dx <= 1 && peak; dx++) {
+
+                    const int nx = x + dx;
+                    if ((dx == 0 && dy == 0) || nx < 0 || nx >= cols)
+                        continue;
+
+                    const bool visited = dy < 0 || (dy == 0 && dx < 0);
+                    peak = visited ? v > n[nx] : v >= n[nx];
+                }
+            }
+
+            if (peak)
+                peaks_.push_back(Peak {v, x, y});
+        }
+    }
+
+    std::stable_sort(peaks_.begin(), peaks_.end(),
+                     [](const Peak &a, const Peak &b) { return a.value > b.value; });
+}
+
+bool BrightSpotDetector::refine(const cv::Mat &roi,
+                                const Peak &peak,
+                                cv::Point2d &centroid,
+                                double &weight,
+                                double &area,
+                                cv::Rect &region) const {
+
+    // Window centered on the decimated pixel
+    const int cx = peak.x * decimate_ + decimate_ / 2;
+    const int cy = peak.y * decimate_ + decimate_ / 2;
+    region = cv::Rect(cx - window_ / 2, cy - window_ / 2, window_, window_)
+             & cv::Rect(0, 0, roi.cols, roi.rows);
+
+    const int cn = roi.channels();
+    const int c = roi.channels() == 1 ? 0 : channel_;
+
+    // Pixels at or above threshold, weighted by how far above they are
+    int64_t m00 = 0, m10 = 0, m01 = 0, n = 0;
+    for (int y = region.y; y < region.y + region.height; y++) {
+
+        const uint8_t *src = roi.ptr<uint8_t>(y);
+        for (int x = region.x; x < region.x + region.width; x++) {
+
+            const uint8_t *p = src + x * cn;
+            const int v = c < 0 ? luma(p) : p[c];
+            if (v < threshold_)
+                continue;
+
+            const int w = v - threshold_ + 1;
+            m00 += w;
+            m10 += static_cast<int64_t>(w) * x;
+            m01 += static_cast<int64_t>(w) * y;
+            n++;
+        }
+    }
+
+    area = static_cast<double>(n);
+    if (m00 == 0 || area < min_object_area_ || area >= max_object_area_)
+        return false;
+
+    weight = static_cast<double>(m00);
+    centroid.x = static_cast<double>(m10) / m00;
+    centroid.y = static_cast<double>(m01) / m00;
+
+    return true;
+}
+
+void BrightSpotDetector::configure(const std::string &config_file,
+                                   const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"channel",
+                                      "threshold",
+                                      "decimate",
+                                      "window",
+                                      "spots",
+                                      "min_area",
+                                      "max_area",
+                                      "search_window",
+                                      "search_misses",
+                                      "max_blobs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Channel (-1 for luma)
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "channel", val, (int64_t)-1, (int64_t)2))
+                channel_ = val;
+        }
+
+        // Intensity threshold
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "threshold", val, (int64_t)1, (int64_t)255))
+                threshold_ = val;
+        }
+
+        // Decimation factor of the peak search
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "decimate", val, (int64_t)1, (int64_t)16))
+                decimate_ = val;
+        }
+
+        // Refinement window
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "window", val, (int64_t)1))
+                window_ = val;
+        }
+
+        // Number of spots
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "spots", val, (int64_t)1, (int64_t)MAX_BLOBS))
+                max_spots_ = val;
+        }
+
+        // Minimum object area
+        oat::config::getValue(this_config, "min_area", min_object_area_, 0.0);
+
+        // Maximum object area
+        oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
+
+        // Search window
+        {
+            int64_t size = 0, misses = 10;
+            oat::config::getValue(this_config, "search_window", size, (int64_t)0);
+            oat::config::getValue(this_config, "search_misses", misses, (int64_t)1);
+            set_search_window(size, misses);
+        }
+
+        // Number of object candidates published to the blob sink
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_blobs", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                set_max_blobs(val);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,99 @@
+//******************************************************************************
+//* File:   BrightSpotDetector.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_BRIGHTSPOTDETECTOR_H
+#define	OAT_BRIGHTSPOTDETECTOR_H
+
+#include <string>
+#include <limits>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "PositionDetector.h"
+
+namespace oat {
+
+// Forward decl.
+class Position2D;
+
+/**
+ * Bright spot (e.g. IR LED) position detector. A single channel, or luma, of
+ * the frame is decimated by taking the maximum of each block of pixels.
+ * Local maxima of the decimated image above threshold are candidate spots,
+ * whose positions are refined by an intensity weighted centroid in a small
+ * full resolution window. No color conversion or contour finding is needed.
+ */
+class BrightSpotDetector : public PositionDetector {
+public:
+
+    /**
+     * Bright spot position detector.
+     * @param frame_source_address Frame SOURCE node address
+     * @param position_sink_address Position SINK node address
+     */
+    BrightSpotDetector(const std::string &frame_source_address,
+                       const std::string &position_sink_address);
+
+    /**
+     * Detect bright spots. The position is the centroid of the brightest
+     * spot or, if several spots are requested, the intensity weighted
+     * centroid of all spots found.
+     * @param frame Frame to look for spots within.
+     * @param position Detected position.
+     */
+    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    // A local maximum of the decimated image
+    struct Peak {
+        int value;
+        int x;
+        int y;
+    };
+
+    // Detector parameters
+    int channel_ {-1};
+    int threshold_ {200};
+    int decimate_ {4};
+    int window_ {15};
+    size_t max_spots_ {1};
+    double min_object_area_ {0.0};
+    double max_object_area_ {std::numeric_limits<double>::max()};
+
+    // Intermediate variables, reused between frames
+    cv::Mat decimated_;
+    std::vector<Peak> peaks_;
+    std::vector<cv::Point2d> spots_;
+
+    void decimate(const cv::Mat &roi);
+    void findPeaks(void);
+    bool refine(const cv::Mat &roi,
+                const Peak &peak,
+                cv::Point2d &centroid,
+                double &weight,
+                double &area,
+                cv::Rect &region) const;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_BRIGHTSPOTDETECTOR_H */
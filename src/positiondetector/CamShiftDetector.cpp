@@ -0,0 +1,284 @@
+//******************************************************************************
+//* File:   CamShiftDetector.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "CamShiftDetector.h"
+
+namespace oat {
+
+// Hue range of 8-bit cv::COLOR_BGR2HSV
+static constexpr float HUE_RANGE {180.0f};
+
+CamShiftDetector::CamShiftDetector(const std::string &frame_source_address,
+                                   const std::string &position_sink_address) :
+  PositionDetector(frame_source_address, position_sink_address)
+{
+    // Only the largest candidate is used to seed the tracker
+    candidates_.set_capacity(1);
+}
+
+void CamShiftDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
+
+    if (tracking_ && track(frame, position))
+        return;
+
+    tracking_ = detect(frame, position);
+}
+
+bool CamShiftDetector::detect(cv::Mat &frame, oat::Position2D &position) {
+
+    // Threshold and filter the search window
+    cv::Mat roi = frame(search_roi_);
+    hsv_threshold_.set(cv::Scalar(h_min_, s_min_, v_min_),
+                       cv::Scalar(h_max_, s_max_, v_max_));
+    hsv_threshold_.apply(roi, threshold_frame_);
+
+    if (erode_px_ > 0)
+        morphology_.erode(threshold_frame_, erode_px_);
+
+    if (dilate_px_ > 0)
+        morphology_.dilate(threshold_frame_, dilate_px_);
+
+    // Largest object in range
+    double area;
+    candidates_.clear();
+    sifter_(threshold_frame_,
+            position,
+            area,
+            min_object_area_,
+            max_object_area_,
+            search_roi_.tl(),
+            &candidates_);
+
+    if (candidates_.empty())
+        return false;
+
+    if (blobs() != nullptr)
+        blobs()->insert(candidates_[0]);
+
+    // Hue histogram of the object's pixels
+    track_window_ = candidates_[0].bounding_box;
+    const cv::Rect mask_box(track_window_.x - search_roi_.x,
+                            track_window_.y - search_roi_.y,
+                            track_window_.width,
+                            track_window_.height);
+    cv::cvtColor(frame(track_window_), hsv_, cv::COLOR_BGR2HSV);
+
+    const int channel = 0;
+    const float hue_range[] = {0, HUE_RANGE};
+    const float *ranges[] = {hue_range};
+    cv::calcHist(&hsv_, 1, &channel, threshold_frame_(mask_box), hist_, 1,
+                 &hist_bins_, ranges);
+    cv::normalize(hist_, hist_, 0, 255, cv::NORM_MINMAX);
+
+    return true;
+}
+
+bool CamShiftDetector::track(cv::Mat &frame, oat::Position2D &position) {
+
+    // Back project the histogram onto a region around the last window,
+    // within the part of the frame this detector may search
+    const int margin = std::max(track_window_.width, track_window_.height) / 2
+                     + margin_px_;
+    const cv::Rect region = cv::Rect(track_window_.x - margin,
+                                     track_window_.y - margin,
+                                     track_window_.width + 2 * margin,
+                                     track_window_.height + 2 * margin)
+                          & search_roi_;
+
+    if (region.area() == 0)
+        return false;
+
+    cv::cvtColor(frame(region), hsv_, cv::COLOR_BGR2HSV);
+
+    const int channel = 0;
+    const float hue_range[] = {0, HUE_RANGE};
+    const float *ranges[] = {hue_range};
+    cv::calcBackProject(&hsv_, 1, &channel, hist_, back_projection_, ranges);
+
+    // Hue is meaningless for dark or unsaturated pixels
+    cv::inRange(hsv_,
+                cv::Scalar(0, s_min_, v_min_),
+                cv::Scalar(HUE_RANGE, s_max_, v_max_),
+                hue_mask_);
+    cv::bitwise_and(back_projection_, hue_mask_, back_projection_);
+
+    cv::Rect window(track_window_.x - region.x,
+                    track_window_.y - region.y,
+                    track_window_.width,
+                    track_window_.height);
+
+    cv::RotatedRect object = cv::CamShift(
+        back_projection_,
+        window,
+        cv::TermCriteria(cv::TermCriteria::EPS | cv::TermCriteria::COUNT, 10, 1));
+
+    window &= cv::Rect(0, 0, region.width, region.height);
+    if (window.area() == 0)
+        return false;
+
+    // Mean back projection within the window is the tracking confidence
+    const double confidence = cv::mean(back_projection_(window))[0] / 255.0;
+    const double area = object.size.area();
+
+    if (confidence < min_confidence_ ||
+        area < min_object_area_ ||
+        area >= max_object_area_)
+        return false;
+
+    track_window_ = cv::Rect(window.x + region.x,
+                             window.y + region.y,
+                             window.width,
+                             window.height);
+
+    position.position.x = object.center.x + region.x;
+    position.position.y = object.center.y + region.y;
+    position.position_valid = true;
+
+    if (blobs() != nullptr) {
+        Blob2D b;
+        b.centroid.x = position.position.x;
+        b.centroid.y = position.position.y;
+        b.area = area;
+        b.bounding_box = track_window_;
+        blobs()->insert(b);
+    }
+
+    return true;
+}
+
+void CamShiftDetector::configure(const std::string &config_file,
+                                 const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"erode",
+                                      "dilate",
+                                      "min_area",
+                                      "max_area",
+                                      "h_thresholds",
+                                      "s_thresholds",
+                                      "v_thresholds",
+                                      "hist_bins",
+                                      "min_confidence",
+                                      "margin",
+                                      "max_blobs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Erode
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "erode", val, (int64_t)0))
+                erode_px_ = val;
+        }
+
+        // Dilate
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "dilate", val, (int64_t)0))
+                dilate_px_ = val;
+        }
+
+        // Minimum object area
+        oat::config::getValue(this_config, "min_area", min_object_area_, 0.0);
+
+        // Maximum object area
+        oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
+
+        // HSV thresholds
+        oat::config::Table t;
+        if (oat::config::getTable(this_config, "h_thresholds", t)) {
+
+            int64_t val;
+            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+            h_min_ = val;
+            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+            h_max_ = val;
+        }
+
+        if (oat::config::getTable(this_config, "s_thresholds", t)) {
+
+            int64_t val;
+            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+            s_min_ = val;
+            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+            s_max_ = val;
+        }
+
+        if (oat::config::getTable(this_config, "v_thresholds", t)) {
+
+            int64_t val;
+            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+            v_min_ = val;
+            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+            v_max_ = val;
+        }
+
+        // Hue histogram bins
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "hist_bins", val, (int64_t)2, (int64_t)180))
+                hist_bins_ = val;
+        }
+
+        // Tracking confidence below which the object is detected again
+        oat::config::getValue(this_config, "min_confidence", min_confidence_, 0.0, 1.0);
+
+        // Margin around the tracking window that is searched
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "margin", val, (int64_t)0))
+                margin_px_ = val;
+        }
+
+        // Number of object candidates published to the blob sink
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_blobs", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                set_max_blobs(val);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,97 @@
+//******************************************************************************
+//* File:   CamShiftDetector.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_CAMSHIFTDETECTOR_H
+#define	OAT_CAMSHIFTDETECTOR_H
+
+#include <string>
+#include <limits>
+#include <opencv2/core/mat.hpp>
+
+#include "../../lib/datatypes/Blobs2D.h"
+#include "../../lib/datatypes/Position2D.h"
+
+#include "ComponentSifter.h"
+#include "HSVThreshold.h"
+#include "PositionDetector.h"
+#include "RectMorphology.h"
+
+namespace oat {
+
+/**
+ * A color-based object tracker. The object is found using HSV thresholding,
+ * as in HSVDetector, and a hue histogram of the object is recorded. In
+ * subsequent frames, the object is followed using CamShift on the histogram
+ * back projection of a region around its last location, so that the cost
+ * per frame depends on the size of the object rather than that of the frame.
+ * The object is detected again when tracking confidence drops.
+ */
+class CamShiftDetector : public PositionDetector {
+public:
+
+    /**
+     * A color-based object tracker with default parameters.
+     * @param frame_source_address Frame SOURCE node address
+     * @param position_sink_address Position SINK node address
+     */
+    CamShiftDetector(const std::string &frame_source_address,
+                     const std::string &position_sink_address);
+
+    /**
+     * Track the object, detecting it if it is not being tracked.
+     * @param Frame to look for object within.
+     * @param position Detected object position.
+     */
+    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    // Detection parameters
+    int erode_px_ {0}, dilate_px_ {10};
+    int h_min_ {0}, h_max_ {256};
+    int s_min_ {0}, s_max_ {256};
+    int v_min_ {0}, v_max_ {256};
+    double min_object_area_ {0.0};
+    double max_object_area_ {std::numeric_limits<double>::max()};
+
+    // Detection
+    oat::HSVThreshold hsv_threshold_;
+    oat::RectMorphology morphology_;
+    oat::ComponentSifter sifter_;
+    oat::Blobs2D candidates_ {"candidates"};
+    cv::Mat threshold_frame_;
+    bool detect(cv::Mat &frame, oat::Position2D &position);
+
+    // Tracking parameters
+    int hist_bins_ {16};
+    double min_confidence_ {0.2};
+    int margin_px_ {20};
+
+    // Tracking
+    bool tracking_ {false};
+    cv::Rect track_window_;
+    cv::Mat hist_, hsv_, hue_mask_, back_projection_;
+    bool track(cv::Mat &frame, oat::Position2D &position);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_CAMSHIFTDETECTOR_H */
@@ -0,0 +1,240 @@
+//******************************************************************************
+//* File:   ComponentSifter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "../../lib/datatypes/Blobs2D.h"
+#include "../../lib/datatypes/Position2D.h"
+
+#include "BandParallel.h"
+#include "ComponentSifter.h"
+
+namespace oat {
+
+void ComponentSifter::operator()(const cv::Mat &frame,
+                                 Position2D &position,
+                                 double &area,
+                                 double min_area,
+                                 double max_area,
+                                 const cv::Point &offset,
+                                 Blobs2D *blobs) {
+
+    if (frame.type() != CV_8UC1)
+        throw std::runtime_error("Connected component labeling requires 8-bit binary frames.");
+
+    label(frame.data, frame.step, frame.rows, frame.cols);
+
+    // Accumulate run statistics into their component roots
+    const Stats empty {0, 0, 0,
+                       std::numeric_limits<int>::max(),
+                       std::numeric_limits<int>::max(),
+                       -1, -1};
+    stats_.assign(runs_.size(), empty);
+
+    for (uint32_t i = 0; i < runs_.size(); i++) {
+
+        const Run &r = runs_[i];
+        Stats &s = stats_[find(parent_, i)];
+        const int64_t n = r.end - r.begin;
+
+        s.area += n;
+        s.sum_x += (r.begin + r.end - 1) * n / 2;
+        s.sum_y += r.row * n;
+        s.min_x = std::min(s.min_x, r.begin);
+        s.max_x = std::max(s.max_x, r.end - 1);
+        s.min_y = std::min(s.min_y, r.row);
+        s.max_y = std::max(s.max_y, r.row);
+    }
+
+    double object_area = 0;
+    position.position_valid = false;
+
+    for (uint32_t i = 0; i < runs_.size(); i++) {
+
+        if (parent_[i] != i)
+            continue;
+
+        const Stats &s = stats_[i];
+        const double a = static_cast<double>(s.area);
+
+        if (a < min_area || a >= max_area)
+            continue;
+
+        const double x = static_cast<double>(s.sum_x) / a + offset.x;
+        const double y = static_cast<double>(s.sum_y) / a + offset.y;
+
+        if (blobs != nullptr) {
+
+            Blob2D b;
+            b.centroid.x = x;
+            b.centroid.y = y;
+            b.area = a;
+            b.bounding_box = cv::Rect(s.min_x + offset.x,
+                                      s.min_y + offset.y,
+                                      s.max_x - s.min_x + 1,
+                                      s.max_y - s.min_y + 1);
+            blobs->insert(b);
+        }
+
+        // Isolate the largest component within the min/max range.
+        if (a > object_area) {
+            position.position.x = x;
+            position.position.y = y;
+            position.position_valid = true;
+            object_area = a;
+        }
+    }
+
+    area = object_area;
+}
+
+void ComponentSifter::label(const uint8_t *data,
+                            size_t step,
+                            int rows,
+                            int cols) {
+
+    if (bands_ <= 1 || rows < 2 * bands_) {
+        labelRows(data, step, cv::Range(0, rows), cols, runs_, parent_);
+        return;
+    }
+
+    band_runs_.resize(bands_);
+    band_parent_.resize(bands_);
+
+    const int n = oat::parallelBands(rows, bands_,
+        [&](int b, const cv::Range &band) {
+            labelRows(data, step, band, cols, band_runs_[b], band_parent_[b]);
+        });
+
+    // Concatenate bands, shifting parents to frame wide run indices
+    runs_.clear();
+    parent_.clear();
+
+    for (int b = 0; b < n; b++) {
+
+        const uint32_t offset = runs_.size();
+        runs_.insert(runs_.end(), band_runs_[b].begin(), band_runs_[b].end());
+        for (auto p : band_parent_[b])
+            parent_.push_back(p + offset);
+
+        if (b == 0)
+            continue;
+
+        // Runs on the last row of the previous band are [prev, offset) and
+        // those on the first row of this band are [offset, curr)
+        const int row = rows * b / n;
+
+        uint32_t prev = offset;
+        while (prev > 0 && runs_[prev - 1].row == row - 1)
+            prev--;
+
+        uint32_t curr = offset;
+        while (curr < runs_.size() && runs_[curr].row == row)
+            curr++;
+
+        // Merge touching runs across the boundary
+        uint32_t j = prev;
+        for (uint32_t i = offset; i < curr; i++) {
+
+            while (j < offset && runs_[j].end < runs_[i].begin)
+                j++;
+
+            for (uint32_t k = j; k < offset && runs_[k].begin <= runs_[i].end; k++)
+                unite(parent_, i, k);
+        }
+    }
+}
+
+void ComponentSifter::labelRows(const uint8_t *data,
+                                size_t step,
+                                const cv::Range &rows,
+                                int cols,
+                                std::vector<Run> &runs,
+                                std::vector<uint32_t> &parent) {
+
+    runs.clear();
+    parent.clear();
+
+    // Runs on the previous row are runs[prev, curr)
+    uint32_t prev = 0, curr = 0;
+
+    for (int y = rows.start; y < rows.end; y++) {
+
+        const uint8_t *p = data + y * step;
+
+        prev = curr;
+        curr = runs.size();
+
+        // First run on the previous row that can touch the next run
+        uint32_t j = prev;
+
+        int x = 0;
+        while (x < cols) {
+
+            while (x < cols && p[x] == 0)
+                x++;
+
+            if (x == cols)
+                break;
+
+            const int begin = x;
+            while (x < cols && p[x] != 0)
+                x++;
+
+            const uint32_t id = runs.size();
+            runs.push_back(Run {y, begin, x});
+            parent.push_back(id);
+
+            // Merge with runs above that overlap [begin - 1, x]
+            while (j < curr && runs[j].end < begin)
+                j++;
+
+            for (uint32_t k = j; k < curr && runs[k].begin <= x; k++)
+                unite(parent, id, k);
+        }
+    }
+}
+
+uint32_t ComponentSifter::find(std::vector<uint32_t> &parent, uint32_t i) {
+
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+
+    return i;
+}
+
+void ComponentSifter::unite(std::vector<uint32_t> &parent,
+                            uint32_t a,
+                            uint32_t b) {
+
+    a = find(parent, a);
+    b = find(parent, b);
+
+    // Roots are always the lowest index in the component
+    if (a < b)
+        parent[b] = a;
+    else if (b < a)
+        parent[a] = b;
+}
+
+} /* namespace oat */
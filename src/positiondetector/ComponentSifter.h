@@ -0,0 +1,119 @@
+//******************************************************************************
+//* File:   ComponentSifter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_COMPONENTSIFTER_H
+#define	OAT_COMPONENTSIFTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+// Forward decl.
+class Position2D;
+class Blobs2D;
+
+/**
+ * Single pass alternative to siftContours. Foreground pixels of a binary
+ * frame are grouped into horizontal runs, runs that touch runs on the previous
+ * row (8-connectivity) are merged using a union-find forest, and the area,
+ * first moments and bounding box of each connected component are accumulated
+ * from its runs. Unlike cv::findContours, the frame is not modified, and
+ * working buffers are kept between frames so that they stop allocating once
+ * they have grown to fit the busiest frame.
+ *
+ * Component area is the number of foreground pixels, so that, unlike a
+ * contour area, it excludes holes.
+ *
+ * Runs can be found in several horizontal bands in parallel. Components that
+ * cross band boundaries are then joined by merging the runs on either side
+ * of each boundary.
+ */
+class ComponentSifter {
+
+public:
+
+    /**
+     * @brief Set the number of bands that are labeled in parallel.
+     * @param bands Number of bands. 1 to label on the calling thread.
+     */
+    void set_bands(const int bands) { bands_ = std::max(1, bands); }
+
+    /**
+     * @brief Find the centroid of the largest connected component with area
+     * in [min_area, max_area).
+     * @param frame 8-bit binary frame. Non-zero pixels are foreground.
+     * @param position Position output
+     * @param area Area of the selected component, or 0 if none was found.
+     * @param min_area Minimum component area (pixels)
+     * @param max_area Maximum component area (pixels)
+     * @param offset Offset added to the returned coordinates, e.g. the origin
+     * of the region of interest that frame was taken from
+     * @param blobs If not null, also collect the largest components within
+     * the min/max range, up to the capacity of the list.
+     */
+    void operator()(const cv::Mat &frame,
+                    Position2D &position,
+                    double &area,
+                    double min_area,
+                    double max_area,
+                    const cv::Point &offset = cv::Point(),
+                    Blobs2D *blobs = nullptr);
+
+private:
+
+    // Horizontal run of foreground pixels, [begin, end)
+    struct Run {
+        int row;
+        int begin;
+        int end;
+    };
+
+    // Accumulated component statistics
+    struct Stats {
+        int64_t area;
+        int64_t sum_x;
+        int64_t sum_y;
+        int min_x, min_y, max_x, max_y;
+    };
+
+    int bands_ {1};
+
+    // Runs and their union-find parents, for the whole frame and per band
+    std::vector<Run> runs_;
+    std::vector<uint32_t> parent_;
+    std::vector<std::vector<Run>> band_runs_;
+    std::vector<std::vector<uint32_t>> band_parent_;
+    std::vector<Stats> stats_;
+
+    void label(const uint8_t *data, size_t step, int rows, int cols);
+    static void labelRows(const uint8_t *data,
+                          size_t step,
+                          const cv::Range &rows,
+                          int cols,
+                          std::vector<Run> &runs,
+                          std::vector<uint32_t> &parent);
+    static uint32_t find(std::vector<uint32_t> &parent, uint32_t i);
+    static void unite(std::vector<uint32_t> &parent, uint32_t a, uint32_t b);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_COMPONENTSIFTER_H */
@@ -17,27 +17,34 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //****************************************************************************
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include "../../lib/datatypes/Blobs2D.h"
 #include "../../lib/datatypes/Position2D.h"
 
+#include "BandParallel.h"
 #include "DetectorFunc.h"
 #include "HSVDetector.h"
 
 namespace oat {
 
 void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &area, double min_area, double max_area) {
+                  double &area, double min_area, double max_area,
+                  const cv::Point &offset,
+                  Blobs2D *blobs) {
 
     std::vector<std::vector <cv::Point> > contours;
 
     // NOTE: This function will modify the frame
     cv::findContours(frame, contours, 
                      cv::RETR_EXTERNAL, 
-                     cv::CHAIN_APPROX_SIMPLE);
+                     cv::CHAIN_APPROX_SIMPLE,
+                     offset);
 
     double object_area = 0;
     position.position_valid = false;
@@ -47,6 +54,23 @@ void siftContours(cv::Mat &frame, Position2D &position,
         cv::Moments moment = cv::moments(static_cast<cv::Mat>(c));
         double countour_area = moment.m00;
 
+        // Degenerate contours (single pixels and lines) have no centroid
+        if (countour_area <= 0)
+            continue;
+
+        // Keep the largest candidates for multi-object output
+        if (blobs != nullptr &&
+            countour_area >= min_area &&
+            countour_area < max_area) {
+
+            Blob2D b;
+            b.centroid.x = moment.m10 / countour_area;
+            b.centroid.y = moment.m01 / countour_area;
+            b.area = countour_area;
+            b.bounding_box = cv::boundingRect(c);
+            blobs->insert(b);
+        }
+
         // Isolate the largest contour within the min/max range.
         if (countour_area >= min_area &&
             countour_area < max_area &&
@@ -62,4 +86,100 @@ void siftContours(cv::Mat &frame, Position2D &position,
     area = object_area;
 }
 
+// Zeroth and first order moments of a binary region
+struct MaskMoments {
+    int64_t m00 {0};
+    int64_t m10 {0};
+    int64_t m01 {0};
+};
+
+static MaskMoments regionMoments(const cv::Mat &frame,
+                                 const cv::Rect &region,
+                                 const int bands) {
+
+    std::vector<MaskMoments> partial(std::max(1, bands));
+
+    const int n = oat::parallelBands(region.height, bands,
+        [&](int b, const cv::Range &rows) {
+
+            MaskMoments &m = partial[b];
+            for (int y = rows.start; y < rows.end; y++) {
+
+                const uint8_t *p = frame.ptr<uint8_t>(region.y + y) + region.x;
+
+                // Branch free so that the row reduction vectorizes
+                int32_t count = 0, sum_x = 0;
+                for (int x = 0; x < region.width; x++) {
+                    const int32_t on = p[x] != 0;
+                    count += on;
+                    sum_x += on * x;
+                }
+
+                m.m00 += count;
+                m.m10 += sum_x + static_cast<int64_t>(count) * region.x;
+                m.m01 += static_cast<int64_t>(count) * (region.y + y);
+            }
+        });
+
+    MaskMoments total;
+    for (int b = 0; b < n; b++) {
+        total.m00 += partial[b].m00;
+        total.m10 += partial[b].m10;
+        total.m01 += partial[b].m01;
+    }
+
+    return total;
+}
+
+void maskCentroid(const cv::Mat &frame, Position2D &position,
+                  double &area, double min_area, double max_area,
+                  int window, int bands,
+                  const cv::Point &offset,
+                  Blobs2D *blobs) {
+
+    position.position_valid = false;
+    area = 0;
+
+    cv::Rect region(0, 0, frame.cols, frame.rows);
+    MaskMoments m = regionMoments(frame, region, bands);
+
+    if (m.m00 == 0)
+        return;
+
+    // Second pass around the first estimate to reject outlying pixels
+    if (window > 0) {
+
+        const int cx = static_cast<int>(m.m10 / m.m00);
+        const int cy = static_cast<int>(m.m01 / m.m00);
+        region = cv::Rect(cx - window / 2, cy - window / 2, window, window)
+                 & cv::Rect(0, 0, frame.cols, frame.rows);
+
+        m = regionMoments(frame, region, bands);
+
+        if (m.m00 == 0)
+            return;
+    }
+
+    const double a = static_cast<double>(m.m00);
+    if (a < min_area || a >= max_area)
+        return;
+
+    position.position.x = m.m10 / a + offset.x;
+    position.position.y = m.m01 / a + offset.y;
+    position.position_valid = true;
+    area = a;
+
+    if (blobs != nullptr) {
+        Blob2D b;
+        b.centroid.x = position.position.x;
+        b.centroid.y = position.position.y;
+        b.area = a;
+        b.bounding_box = cv::Rect(region.x + offset.x,
+                                  region.y + offset.y,
+                                  region.width,
+                                  region.height);
+        blobs->insert(b);
+    }
+}
+
 } /* namespace oat */
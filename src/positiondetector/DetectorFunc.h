@@ -20,6 +20,8 @@
 #ifndef OAT_DETECTORFUNC
 #define	OAT_DETECTORFUNC
 
+#include <opencv2/core/types.hpp>
+
 // Forward decl.
 namespace cv { class Mat; }
 
@@ -30,6 +32,7 @@ static constexpr double PI {3.14159265358979323846};
 
 // Forward decl.
 class Position2D;
+class Blobs2D;
 
 /**
  * Given a binary frame, find all contours and return a position corresponding
@@ -38,10 +41,40 @@ class Position2D;
  * @param position Position output
  * @param min_area Minimum contour area to be considered candidate for position
  * @param max_area Maximum contour area to be considered candidate for position
+ * @param offset Offset added to contour points, e.g. the origin of the region
+ * of interest that frame was taken from
+ * @param blobs If not null, also collect the largest contours within the
+ * min/max range, up to the capacity of the list, from the same pass.
  * @return Position corresponding the centroid of the largest contour in the frame.
  */
 void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &object_area, double min_area, double max_area);
+                  double &object_area, double min_area, double max_area,
+                  const cv::Point &offset = cv::Point(),
+                  Blobs2D *blobs = nullptr);
+
+/**
+ * Given a binary frame, return the centroid of all foreground pixels,
+ * computed directly from the zeroth and first order moments of the frame
+ * without finding contours. Suitable when the frame contains a single
+ * object.
+ * @param frame Binary frame to look for position in. Not modified.
+ * @param position Position output
+ * @param object_area Number of foreground pixels used for the centroid
+ * @param min_area Minimum object area for the position to be valid
+ * @param max_area Maximum object area for the position to be valid
+ * @param window If greater than 0, the moments are taken a second time
+ * within a square window of this side length centered on the first
+ * estimate, so that foreground pixels far from the object are ignored.
+ * @param bands Number of horizontal bands to reduce in parallel
+ * @param offset Offset added to the returned position
+ * @param blobs If not null, the object, with the region its moments were
+ * taken over as its bounding box, is added to the list.
+ */
+void maskCentroid(const cv::Mat &frame, Position2D &position,
+                  double &object_area, double min_area, double max_area,
+                  int window = 0, int bands = 1,
+                  const cv::Point &offset = cv::Point(),
+                  Blobs2D *blobs = nullptr);
 
 }       /* namespace oat */
 #endif	/* OAT_DETECTORFUNC */
@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
 #include <string>
 #include <opencv2/cvconfig.h>
 #include <opencv2/opencv.hpp>
@@ -33,6 +34,9 @@
 
 namespace oat {
 
+// Tuning window sliders, in the order they are added
+enum DiffSlider : size_t { THRESH = 0, BLUR, MIN_AREA, MAX_AREA };
+
 DifferenceDetector::DifferenceDetector(const std::string &frame_source_address,
                                            const std::string &position_sink_address) :
   PositionDetector(frame_source_address, position_sink_address)
@@ -45,24 +49,42 @@ DifferenceDetector::DifferenceDetector(const std::string &frame_source_address,
 
 void DifferenceDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
+    // Take parameters changed in the tuning window
     if (tuning_on_)
-        tune_frame_ = frame.clone();
-
-    applyThreshold(frame);
-
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-         tune_frame_.setTo(0, threshold_frame_ == 0);
-
-    siftContours(threshold_frame_,
-                 position,
-                 object_area_,
-                 min_object_area_,
-                 max_object_area_);
+        tune();
+
+    difference_engine_.set_threshold(difference_intensity_threshold_);
+    difference_engine_.set_blur(blur_on_ ? blur_size_ : cv::Size(0, 0));
+    difference_engine_.set_bands(bands_);
+
+    // Arenas only convert and keep their own region of the frame
+    difference_engine_.set_bounds(bounds(frame.size()));
+
+    difference_engine_.apply(frame, search_roi_, threshold_frame_);
+
+    // Threshold frame will be destroyed by the transform below, so it is
+    // copied for the tuning window here, but only when the window is due for
+    // a new image
+    auto *snapshot = tuner_ ? tuner_->snapshot() : nullptr;
+    if (snapshot) {
+        frame.copyTo(snapshot->frame);
+        snapshot->mask.create(frame.size(), CV_8UC1);
+        snapshot->mask.setTo(0);
+        threshold_frame_.copyTo(snapshot->mask(search_roi_));
+    }
 
-    if (tuning_on_)
-        tune(tune_frame_, position);
+    siftObjects(threshold_frame_,
+                position,
+                object_area_,
+                min_object_area_,
+                max_object_area_);
+
+    if (snapshot) {
+        snapshot->position = position.position;
+        snapshot->position_valid = position.position_valid;
+        snapshot->area = object_area_;
+        tuner_->show();
+    }
 }
 
 void DifferenceDetector::configure(const std::string& config_file,
@@ -71,8 +93,16 @@ void DifferenceDetector::configure(const std::string& config_file,
     // Available options
     std::vector<std::string> options {"blur",
                                       "diff_threshold",
+                                      "lag",
                                       "min_area",
                                       "max_area",
+                                      "search_window",
+                                      "search_misses",
+                                      "max_blobs",
+                                      "components",
+                                      "moments",
+                                      "moments_window",
+                                      "bands",
                                       "tune"};
 
     // This will throw cpptoml::parse_exception if a file
@@ -102,12 +132,53 @@ void DifferenceDetector::configure(const std::string& config_file,
             difference_intensity_threshold_ = val;
         }
 
+        // Frames between differenced frames
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "lag", val, (int64_t)1))
+                difference_engine_.set_lag(val);
+        }
+
         // Minimum object area
         oat::config::getValue(this_config, "min_area", min_object_area_, 0.0);
 
         // Maximum object area
         oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
 
+        // Search window
+        {
+            int64_t size = 0, misses = 10;
+            oat::config::getValue(this_config, "search_window", size, (int64_t)0);
+            oat::config::getValue(this_config, "search_misses", misses, (int64_t)1);
+            set_search_window(size, misses);
+        }
+
+        // Connected component labeling
+        oat::config::getValue(this_config, "components", use_components_);
+
+        // Single object centroid from mask moments
+        oat::config::getValue(this_config, "moments", use_moments_);
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "moments_window", val, (int64_t)0))
+                moments_window_ = val;
+        }
+
+        // Parallel bands
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "bands", val, (int64_t)0))
+                set_bands(val);
+        }
+
+        // Number of object candidates published to the blob sink
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_blobs", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                set_max_blobs(val);
+        }
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -117,82 +188,36 @@ void DifferenceDetector::configure(const std::string& config_file,
 
 }
 
-void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
+void DifferenceDetector::tune() {
 
-    if (!tuning_windows_created_) 
+    if (!tuner_)
         createTuningWindows();
-    
-    std::string msg = cv::format("Object not found");
-
-    // Plot a circle representing found object
-    if (position.position_valid) {
-
-        // TODO: object_area_ is not set, so this will be 0!
-        auto radius = std::sqrt(object_area_ / PI);
-        cv::Point center;
-        center.x = position.position.x;
-        center.y = position.position.y;
-        cv::circle(frame, center, radius, cv::Scalar(0, 0, 255), 4);
-        msg = cv::format("(%d, %d) pixels",
-                (int) position.position.x,
-                (int) position.position.y);
-    }
-
-    int baseline = 0;
-    cv::Size textSize = cv::getTextSize(msg, 1, 1, 1, &baseline);
-    cv::Point text_origin(
-            frame.cols - textSize.width - 10,
-            frame.rows - 2 * baseline - 10);
 
-    cv::putText(frame, msg, text_origin, 1, 1, cv::Scalar(0, 255, 0));
+    // Values are taken as a set, only when a slider has moved
+    if (!tuner_->update())
+        return;
 
-    cv::imshow(tuning_image_title_, frame);
-    cv::waitKey(1);
-}
-
-void DifferenceDetector::applyThreshold(cv::Mat &frame) {
-
-    if (last_image_set_) {
-        cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
-        cv::absdiff(frame, last_image_, threshold_frame_);
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        if (blur_on_) {
-            cv::blur(threshold_frame_, threshold_frame_, blur_size_);
-        }
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        last_image_ = frame.clone(); // Get a copy of the last image
-    } else {
-        threshold_frame_ = frame.clone();
-        cv::cvtColor(threshold_frame_, threshold_frame_, cv::COLOR_BGR2GRAY);
-        last_image_ = frame.clone();
-        cv::cvtColor(last_image_, last_image_, cv::COLOR_BGR2GRAY);
-        last_image_set_ = true;
-    }
+    difference_intensity_threshold_ = tuner_->value(THRESH);
+    set_blur_size(tuner_->value(BLUR));
+    set_min_object_area(tuner_->value(MIN_AREA));
+    set_max_object_area(tuner_->value(MAX_AREA));
 }
 
 void DifferenceDetector::createTuningWindows() {
 
-#ifdef HAVE_OPENGL
-    try {
-        cv::namedWindow(tuning_image_title_, cv::WINDOW_OPENGL & cv::WINDOW_KEEPRATIO);
-    } catch (cv::Exception& ex) {
-        whoWarn(name_, "OpenCV not compiled with OpenGL support. Falling back to OpenCV's display driver.\n");
-        cv::namedWindow(tuning_image_title_, cv::WINDOW_NORMAL & cv::WINDOW_KEEPRATIO);
-    }
-#else
-    cv::namedWindow(tuning_image_title_, cv::WINDOW_NORMAL);
-#endif
+    tuner_.reset(new oat::TuningWindow(tuning_image_title_));
 
     // Create sliders and insert them into window
-    cv::createTrackbar("THRESH", tuning_image_title_,
-            &difference_intensity_threshold_, 256);
-    cv::createTrackbar("BLUR", tuning_image_title_,
-            &blur_size_.height, 50, &diffDetectorBlurSliderChangedCallback, this);
-    cv::createTrackbar("MIN AREA", tuning_image_title_,
-            &dummy0_, 10000, &diffDetectorMinAreaSliderChangedCallback, this);
-    cv::createTrackbar("MAX AREA", tuning_image_title_,
-            &dummy1_, 10000, &diffDetectorMaxAreaSliderChangedCallback, this);
-    tuning_windows_created_ = true;
+    tuner_->addSlider("THRESH", difference_intensity_threshold_, 256);
+    tuner_->addSlider("BLUR", blur_on_ ? blur_size_.height : 0, 50);
+    tuner_->addSlider("MIN AREA",
+                      static_cast<int>(std::min(min_object_area_, 10000.0)),
+                      10000);
+    tuner_->addSlider("MAX AREA",
+                      static_cast<int>(std::min(max_object_area_, 10000.0)),
+                      10000);
+
+    tuner_->start();
 }
 
 void DifferenceDetector::set_blur_size(int value) {
@@ -205,20 +230,4 @@ void DifferenceDetector::set_blur_size(int value) {
     }
 }
 
-// Non-member GUI callback functions
-void diffDetectorBlurSliderChangedCallback(int value, void * object) {
-    auto diff_detector = static_cast<DifferenceDetector *>(object);
-    diff_detector->set_blur_size(value);
-}
-
-void diffDetectorMinAreaSliderChangedCallback(int value, void * object) {
-    auto diff_detector = static_cast<DifferenceDetector *>(object);
-    diff_detector->set_min_object_area(static_cast<double>(value));
-}
-
-void diffDetectorMaxAreaSliderChangedCallback(int value, void * object) {
-    auto diff_detector = static_cast<DifferenceDetector *>(object);
-    diff_detector->set_max_object_area(static_cast<double>(value));
-}
-
 } /* namespace oat */
@@ -22,8 +22,12 @@
 
 #include <string>
 #include <limits>
+#include <memory>
 #include <opencv2/core/mat.hpp>
 
+#include "../../lib/utility/TuningWindow.h"
+
+#include "DifferenceEngine.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -63,9 +67,8 @@ public:
 private:
 
     // Intermediate variables
-    cv::Mat this_image_, last_image_;
+    oat::DifferenceEngine difference_engine_;
     cv::Mat threshold_frame_;
-    bool last_image_set_ {false};
 
     // Object detection
     double object_area_ {0.0};
@@ -77,22 +80,15 @@ private:
     double min_object_area_ {0.0};
     double max_object_area_ {std::numeric_limits<double>::max()};
 
-    // Tuning stuff
+    // Tuning GUI, run on its own thread
     const std::string tuning_image_title_;
-    cv::Mat tune_frame_;
-    int dummy0_ {0}, dummy1_ {10000};
+    std::unique_ptr<oat::TuningWindow> tuner_;
 
     // Processing functions
     void createTuningWindows(void);
-    void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void tune(void);
 };
 
-// Tuning GUI callbacks
-void diffDetectorBlurSliderChangedCallback(int value, void *);
-void diffDetectorMinAreaSliderChangedCallback(int value, void *);
-void diffDetectorMaxAreaSliderChangedCallback(int value, void *);
-
 }       /* namespace oat */
 #endif	/* OAT_DIFFERENCEDETECTOR_H */
 
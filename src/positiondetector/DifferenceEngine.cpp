@@ -0,0 +1,245 @@
+//******************************************************************************
+//* File:   DifferenceEngine.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "BandParallel.h"
+#include "DifferenceEngine.h"
+
+namespace oat {
+
+// Fixed point BGR to gray coefficients, as used by cv::cvtColor
+static constexpr int GRAY_SHIFT {14};
+static constexpr int GRAY_B {1868};
+static constexpr int GRAY_G {9617};
+static constexpr int GRAY_R {4899};
+
+// Index into [0, n) with reflection that excludes the edge (BORDER_REFLECT_101)
+static inline int reflect101(int i, const int n) {
+
+    if (n == 1)
+        return 0;
+
+    while (i < 0 || i >= n)
+        i = i < 0 ? -i : 2 * n - 2 - i;
+
+    return i;
+}
+
+void DifferenceEngine::set_threshold(const int threshold) {
+
+    if (threshold != threshold_) {
+        threshold_ = threshold;
+        updateMinCount();
+    }
+}
+
+void DifferenceEngine::set_blur(const cv::Size &size) {
+
+    const cv::Size s = size.width > 0 && size.height > 0 ? size : cv::Size(0, 0);
+    if (s != blur_) {
+        blur_ = s;
+        updateMinCount();
+    }
+}
+
+void DifferenceEngine::set_lag(const int lag) {
+
+    const int l = lag > 1 ? lag : 1;
+    if (l != lag_) {
+        lag_ = l;
+        history_.clear();
+        count_ = 0;
+        head_ = 0;
+    }
+}
+
+void DifferenceEngine::updateMinCount() {
+
+    if (blur_.area() == 0)
+        return;
+
+    // Blurred value is the box mean of 0/255 pixels, rounded
+    const int n = blur_.area();
+    min_count_ = n + 1;
+    for (int c = 0; c <= n; c++) {
+        if ((2 * 255 * c + n) / (2 * n) > threshold_) {
+            min_count_ = c;
+            break;
+        }
+    }
+}
+
+bool DifferenceEngine::apply(const cv::Mat &frame,
+                             const cv::Rect &roi,
+                             cv::Mat &mask) {
+
+    if (frame.depth() != CV_8U ||
+        (frame.channels() != 3 && frame.channels() != 1))
+        throw std::runtime_error("Frame differencing requires 8-bit BGR or grayscale frames.");
+
+    // Only the bounded region of the frame is converted and kept
+    const cv::Rect full(cv::Point(0, 0), frame.size());
+    const cv::Rect region = bounds_.area() > 0 ? bounds_ & full : full;
+    if ((roi & region) != roi)
+        throw std::runtime_error("Difference region lies outside of the detector bounds.");
+
+    // Allocate the frame ring on the first frame or if the region changes
+    if (history_.size() != static_cast<size_t>(lag_ + 1) || region != region_) {
+
+        history_.assign(lag_ + 1, cv::Mat());
+        for (auto &h : history_)
+            h.create(region.size(), CV_8UC1);
+        region_ = region;
+        count_ = 0;
+        head_ = 0;
+    }
+
+    cv::Mat &gray = history_[head_];
+    const cv::Mat &old = history_[(head_ + 1) % history_.size()];
+    const bool ready = count_ >= static_cast<size_t>(lag_);
+    const bool blur = blur_.area() > 0;
+
+    mask.create(roi.size(), CV_8UC1);
+
+    // Without a box filter, the fused pass writes the mask directly
+    cv::Mat &out = blur ? binary_ : mask;
+    if (blur)
+        binary_.create(roi.size(), CV_8UC1);
+
+    oat::parallelBands(region.height, bands_,
+        [&](int, const cv::Range &rows) {
+            grayDifference(frame, ready ? old : cv::Mat(), region, roi, rows,
+                           gray, out, blur ? 1 : 255);
+        });
+
+    head_ = (head_ + 1) % history_.size();
+    count_++;
+
+    if (!ready) {
+        mask.setTo(0);
+        return false;
+    }
+
+    if (blur) {
+        column_sums_.resize(bands_);
+        oat::parallelBands(roi.height, bands_,
+            [&](int b, const cv::Range &rows) {
+                boxThreshold(rows, column_sums_[b], mask);
+            });
+    }
+
+    return true;
+}
+
+void DifferenceEngine::grayDifference(const cv::Mat &frame,
+                                      const cv::Mat &old,
+                                      const cv::Rect &region,
+                                      const cv::Rect &roi,
+                                      const cv::Range &rows,
+                                      cv::Mat &gray,
+                                      cv::Mat &out,
+                                      const uint8_t on) const {
+
+    // Rows are relative to region, as are gray and old
+    const int cols = region.width;
+    const bool bgr = frame.channels() == 3;
+    const bool diff = !old.empty();
+    const int x0 = roi.x - region.x, x1 = x0 + roi.width;
+    const int y0 = roi.y - region.y, y1 = y0 + roi.height;
+    const int t = threshold_;
+
+    for (int y = rows.start; y < rows.end; y++) {
+
+        const uint8_t *s = frame.ptr<uint8_t>(y + region.y)
+                           + region.x * frame.channels();
+        uint8_t *g = gray.ptr<uint8_t>(y);
+
+        // Convert the row
+        if (bgr) {
+            for (int x = 0; x < cols; x++)
+                g[x] = static_cast<uint8_t>((s[3 * x] * GRAY_B
+                                             + s[3 * x + 1] * GRAY_G
+                                             + s[3 * x + 2] * GRAY_R
+                                             + (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+        } else {
+            std::copy(s, s + cols, g);
+        }
+
+        if (!diff || y < y0 || y >= y1)
+            continue;
+
+        // Difference and threshold the region of interest while the row is
+        // still in cache
+        const uint8_t *o = old.ptr<uint8_t>(y);
+        uint8_t *d = out.ptr<uint8_t>(y - y0) - x0;
+        for (int x = x0; x < x1; x++)
+            d[x] = std::abs(g[x] - o[x]) > t ? on : 0;
+    }
+}
+
+void DifferenceEngine::boxThreshold(const cv::Range &rows,
+                                    std::vector<int> &sums,
+                                    cv::Mat &mask) const {
+
+    const int width = binary_.cols, height = binary_.rows;
+    const int kw = blur_.width, kh = blur_.height;
+    const int aw = kw / 2, ah = kh / 2;
+
+    // Only indices that fall outside the row need to be reflected
+    auto col = [width](const int i) {
+        return static_cast<unsigned>(i) < static_cast<unsigned>(width) ?
+               i : reflect101(i, width);
+    };
+
+    // Column sums over the kernel rows for the first row of the band
+    sums.assign(width, 0);
+    for (int i = 0; i < kh; i++) {
+        const uint8_t *b = binary_.ptr<uint8_t>(reflect101(rows.start - ah + i, height));
+        for (int x = 0; x < width; x++)
+            sums[x] += b[x];
+    }
+
+    for (int y = rows.start; y < rows.end; y++) {
+
+        uint8_t *m = mask.ptr<uint8_t>(y);
+
+        // Slide the kernel along the row
+        int c = 0;
+        for (int i = 0; i < kw; i++)
+            c += sums[col(i - aw)];
+
+        for (int x = 0; x < width; x++) {
+            m[x] = c >= min_count_ ? 255 : 0;
+            c += sums[col(x - aw + kw)] - sums[col(x - aw)];
+        }
+
+        // Slide the kernel down a row
+        if (y + 1 < rows.end) {
+            const uint8_t *out = binary_.ptr<uint8_t>(reflect101(y - ah, height));
+            const uint8_t *in = binary_.ptr<uint8_t>(reflect101(y - ah + kh, height));
+            for (int x = 0; x < width; x++)
+                sums[x] += in[x] - out[x];
+        }
+    }
+}
+
+} /* namespace oat */
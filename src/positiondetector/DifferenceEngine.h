@@ -0,0 +1,127 @@
+//******************************************************************************
+//* File:   DifferenceEngine.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_DIFFERENCEENGINE_H
+#define	OAT_DIFFERENCEENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Temporal difference thresholding for motion detection. Each frame is
+ * converted to grayscale, differenced against the frame lag frames earlier
+ * and thresholded in a single fused pass. The result is optionally smoothed
+ * with a box filter built on running sums and thresholded again. Grayscale
+ * frames are kept in a ring that is allocated once, so that, in steady
+ * state, nothing is allocated or cloned per frame.
+ *
+ * Results match cv::cvtColor(COLOR_BGR2GRAY), cv::absdiff,
+ * cv::threshold(THRESH_BINARY), cv::blur and cv::threshold(THRESH_BINARY)
+ * applied in sequence, up to rounding of the blurred value.
+ */
+class DifferenceEngine {
+
+public:
+
+    /**
+     * @brief Set the intensity difference threshold.
+     * @param threshold Differences greater than this are foreground.
+     */
+    void set_threshold(const int threshold);
+
+    /**
+     * @brief Set the box filter size. Sizes of 0 disable filtering.
+     */
+    void set_blur(const cv::Size &size);
+
+    /**
+     * @brief Difference each frame against the frame this many frames
+     * earlier. Changing it discards the frame history.
+     */
+    void set_lag(const int lag);
+
+    /**
+     * @brief Number of horizontal bands processed in parallel.
+     */
+    void set_bands(const int bands) { bands_ = bands > 1 ? bands : 1; }
+
+    /**
+     * @brief Confine the engine to a region of the frame, e.g. an arena.
+     * Only this region is converted to grayscale and kept for future
+     * differences. An empty region selects the whole frame. Changing it
+     * discards the frame history.
+     */
+    void set_bounds(const cv::Rect &bounds) { bounds_ = bounds; }
+
+    /**
+     * @brief Difference and threshold a frame.
+     * @param frame 8-bit BGR or grayscale frame.
+     * @param roi Region of the frame to difference. Must lie within the
+     * bounds. The whole of the bounds is kept for future differences, so
+     * that roi may move between frames.
+     * @param mask 8-bit mask the size of roi, 255 where motion was detected
+     * and 0 elsewhere. Reallocated only if its size or type differ.
+     * @return False if fewer than lag earlier frames are available, in which
+     * case mask is zero.
+     */
+    bool apply(const cv::Mat &frame, const cv::Rect &roi, cv::Mat &mask);
+
+private:
+
+    int threshold_ {0};
+    cv::Size blur_ {0, 0};
+    int lag_ {1};
+    int bands_ {1};
+    cv::Rect bounds_;
+
+    // Smallest number of foreground pixels within the box filter for which
+    // the blurred value exceeds the threshold
+    int min_count_ {1};
+
+    // Grayscale ring of the bounded region of the frame, region_. head_ is
+    // the slot for the next frame.
+    std::vector<cv::Mat> history_;
+    cv::Rect region_;
+    size_t head_ {0};
+    size_t count_ {0};
+
+    // Binary (0/1) difference of the region of interest, and per band
+    // running column sums for the box filter
+    cv::Mat binary_;
+    std::vector<std::vector<int>> column_sums_;
+
+    void updateMinCount(void);
+    void grayDifference(const cv::Mat &frame,
+                        const cv::Mat &old,
+                        const cv::Rect &region,
+                        const cv::Rect &roi,
+                        const cv::Range &rows,
+                        cv::Mat &gray,
+                        cv::Mat &out,
+                        const uint8_t on) const;
+    void boxThreshold(const cv::Range &rows,
+                      std::vector<int> &sums,
+                      cv::Mat &mask) const;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_DIFFERENCEENGINE_H */
@@ -0,0 +1,129 @@
+//******************************************************************************
+//* File:   HSVClassifier.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
+
+#include "HSVClassifier.h"
+
+namespace oat {
+
+void forEachHSVSlice(const std::function<void(int, const cv::Mat &)> &f) {
+
+    // Every G, R combination. The blue channel is filled in for each slice.
+    cv::Mat slice(256, 256, CV_8UC3), hsv;
+    for (int g = 0; g < 256; g++) {
+        auto *p = slice.ptr<uint8_t>(g);
+        for (int r = 0; r < 256; r++) {
+            p[3 * r + 1] = g;
+            p[3 * r + 2] = r;
+        }
+    }
+
+    for (int b = 0; b < 256; b++) {
+
+        for (int g = 0; g < 256; g++) {
+            auto *p = slice.ptr<uint8_t>(g);
+            for (int r = 0; r < 256; r++)
+                p[3 * r] = b;
+        }
+
+        cv::cvtColor(slice, hsv, cv::COLOR_BGR2HSV);
+        f(b, hsv);
+    }
+}
+
+void HSVClassifier::set(const std::vector<cv::Scalar> &min,
+                        const std::vector<cv::Scalar> &max) {
+
+    if (min.size() != max.size() || min.size() > MAX_HSV_CLASSES)
+        throw std::runtime_error("Invalid number of HSV pass bands.");
+
+    if (built_ && min == min_ && max == max_)
+        return;
+
+    min_ = min;
+    max_ = max;
+    build();
+}
+
+void HSVClassifier::build() {
+
+    table_.assign(1 << 24, 0);
+
+    cv::Mat mask;
+    forEachHSVSlice([this, &mask](int b, const cv::Mat &hsv) {
+
+        for (size_t k = 0; k < min_.size(); k++) {
+
+            cv::inRange(hsv, min_[k], max_[k], mask);
+
+            // Each row of the slice is 256 consecutive table entries
+            const uint8_t bit = 1 << k;
+            for (int g = 0; g < 256; g++) {
+                const auto *m = mask.ptr<uint8_t>(g);
+                uint8_t *t = &table_[(b << 16) | (g << 8)];
+                for (int r = 0; r < 256; r++)
+                    t[r] |= m[r] & bit;
+            }
+        }
+    });
+
+    built_ = true;
+}
+
+void HSVClassifier::apply(const cv::Mat &frame, std::vector<cv::Mat> &masks) const {
+
+    if (frame.type() != CV_8UC3)
+        throw std::runtime_error("HSV thresholding requires 8-bit BGR frames.");
+
+    const size_t n = min_.size();
+    masks.resize(n);
+
+    bool continuous = frame.isContinuous();
+    for (auto &m : masks) {
+        m.create(frame.size(), CV_8UC1);
+        continuous = continuous && m.isContinuous();
+    }
+
+    const uint8_t *table = table_.data();
+
+    int rows = frame.rows;
+    int cols = frame.cols;
+    if (continuous) {
+        cols *= rows;
+        rows = 1;
+    }
+
+    uint8_t *m[MAX_HSV_CLASSES];
+    for (int i = 0; i < rows; i++) {
+
+        const uint8_t *p = frame.ptr<uint8_t>(i);
+        for (size_t k = 0; k < n; k++)
+            m[k] = masks[k].ptr<uint8_t>(i);
+
+        for (int j = 0; j < cols; j++, p += 3) {
+            const uint8_t c = table[(p[0] << 16) | (p[1] << 8) | p[2]];
+            for (size_t k = 0; k < n; k++)
+                m[k][j] = -static_cast<uint8_t>((c >> k) & 1);
+        }
+    }
+}
+
+}       /* namespace oat */
@@ -0,0 +1,81 @@
+//******************************************************************************
+//* File:   HSVClassifier.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_HSVCLASSIFIER_H
+#define	OAT_HSVCLASSIFIER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+// Constants
+static constexpr size_t MAX_HSV_CLASSES {8};
+
+/**
+ * @brief Convert every 24-bit BGR color to HSV, for building lookup tables.
+ * Colors are converted one 256 x 256 slice of constant blue at a time.
+ * @param f Called with signature void(int b, const cv::Mat &hsv) for each
+ * blue value. Row g, column r of hsv holds the HSV value of color (b, g, r).
+ */
+void forEachHSVSlice(const std::function<void(int, const cv::Mat &)> &f);
+
+/**
+ * Several HSV pass bands applied directly to BGR frames in a single pass.
+ * As in HSVThreshold, every 24-bit BGR color is converted to HSV and tested
+ * when the pass bands change, but here against each band, and the results
+ * are packed into a 16 MB table holding one bit per band. Classifying a frame
+ * is then a single lookup per pixel, however many bands there are.
+ */
+class HSVClassifier {
+
+public:
+
+    /**
+     * @brief Set the HSV pass bands. The lookup table is only rebuilt if they
+     * differ from the current ones.
+     * @param min Inclusive lower H, S and V bounds of each band.
+     * @param max Inclusive upper H, S and V bounds of each band.
+     */
+    void set(const std::vector<cv::Scalar> &min,
+             const std::vector<cv::Scalar> &max);
+
+    /**
+     * @brief Classify a frame.
+     * @param frame 8-bit BGR frame.
+     * @param masks One 8-bit mask per band, 255 where the frame is inside the
+     * band and 0 elsewhere. Reallocated only if their size or type differ.
+     */
+    void apply(const cv::Mat &frame, std::vector<cv::Mat> &masks) const;
+
+private:
+
+    std::vector<cv::Scalar> min_, max_;
+    bool built_ {false};
+
+    // Band membership bits for each BGR color, indexed by (B << 16) | (G << 8) | R
+    std::vector<uint8_t> table_;
+
+    void build(void);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_HSVCLASSIFIER_H */
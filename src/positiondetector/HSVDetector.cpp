@@ -19,6 +19,7 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <algorithm>
 #include <string>
 #include <limits>
 #include <opencv2/opencv.hpp>
@@ -28,11 +29,19 @@
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/TOMLSanitize.h"
 
+#include "BandParallel.h"
 #include "DetectorFunc.h"
 #include "HSVDetector.h"
+#include "HSVThreshold.h"
 
 namespace oat {
 
+// Tuning window sliders, in the order they are added
+enum HSVSlider : size_t {
+    H_MIN = 0, H_MAX, S_MIN, S_MAX, V_MIN, V_MAX,
+    MIN_AREA, MAX_AREA, ERODE, DILATE
+};
+
 HSVDetector::HSVDetector(const std::string &frame_source_address,
                          const std::string &position_sink_address) :
   PositionDetector(frame_source_address, position_sink_address)
@@ -47,39 +56,197 @@ HSVDetector::HSVDetector(const std::string &frame_source_address,
 
 void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
-    // Transform frame to HSV
-    // (Extremely expensive operation)
-    cv::cvtColor(frame, frame, cv::COLOR_BGR2HSV);
+    // Take parameters changed in the tuning window
+    if (tuning_on_)
+        tune();
+
+    // Only the search window is thresholded and searched
+    cv::Mat roi = frame(search_roi_);
+
+    // The table is only rebuilt when the thresholds change. Rebuilding it
+    // would stall detection each time a tuning slider moves, so frames are
+    // converted to HSV instead while tuning.
+    lut_on_ = use_lut_ && !tuning_on_;
+    if (lut_on_)
+        hsv_threshold_.set(cv::Scalar(h_min_, s_min_, v_min_),
+                           cv::Scalar(h_max_, s_max_, v_max_));
+
+    if (coarse_ > 1 && roi.rows >= coarse_ && roi.cols >= coarse_ &&
+        applyCoarseToFine(roi)) {
+
+        // Candidates were refined at full resolution
+
+    } else if (bands_ <= 1) {
+
+        // Convert to HSV in place, unless the frame is shown for tuning
+        applyThreshold(roi,
+                       tuning_on_ ? hsv_frame_ : roi,
+                       threshold_frame_,
+                       morphology_);
+
+    } else {
+
+        // Bands are extended by the reach of the erode and dilate kernels so
+        // that filtering them separately is equivalent to filtering the
+        // whole window
+        const int halo = (erode_on_ ? erode_px_ : 0)
+                       + (dilate_on_ ? dilate_px_ : 0);
+
+        threshold_frame_.create(roi.size(), CV_8UC1);
+        band_hsv_.resize(bands_);
+        band_threshold_.resize(bands_);
+        band_morphology_.resize(bands_);
+
+        oat::parallelBands(roi.rows, bands_,
+            [&](int b, const cv::Range &core) {
+
+                cv::Range ext(std::max(0, core.start - halo),
+                              std::min(roi.rows, core.end + halo));
+
+                applyThreshold(roi.rowRange(ext),
+                               band_hsv_[b],
+                               band_threshold_[b],
+                               band_morphology_[b]);
+
+                band_threshold_[b].rowRange(core.start - ext.start,
+                                            core.end - ext.start)
+                    .copyTo(threshold_frame_.rowRange(core));
+            });
+    }
+
+    // Threshold frame will be destroyed by the transform below, so it is
+    // copied for the tuning window here, but only when the window is due for
+    // a new image
+    auto *snapshot = tuner_ ? tuner_->snapshot() : nullptr;
+    if (snapshot) {
+        frame.copyTo(snapshot->frame);
+        snapshot->mask.create(frame.size(), CV_8UC1);
+        snapshot->mask.setTo(0);
+        threshold_frame_.copyTo(snapshot->mask(search_roi_));
+    }
+
+    // Find the largest contour in the threshold image
+    siftObjects(threshold_frame_,
+                position,
+                object_area_,
+                min_object_area_,
+                max_object_area_);
+
+    if (snapshot) {
+        snapshot->position = position.position;
+        snapshot->position_valid = position.position_valid;
+        snapshot->area = object_area_;
+        tuner_->show();
+    }
+}
+
+void HSVDetector::applyThreshold(const cv::Mat &frame,
+                                 cv::Mat &hsv,
+                                 cv::Mat &threshold,
+                                 oat::RectMorphology &morphology,
+                                 const bool filter) const {
+
+    if (lut_on_) {
+
+        // Threshold BGR pixels using a table of the HSV pass band
+        hsv_threshold_.apply(frame, threshold);
+
+    } else {
+
+        // Transform frame to HSV
+        // (Extremely expensive operation)
+        cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
+
+        // Threshold HSV channels
+        // (Very expensive operation)
+        cv::inRange(hsv,
+                    cv::Scalar(h_min_, s_min_, v_min_),
+                    cv::Scalar(h_max_, s_max_, v_max_),
+                    threshold);
+    }
 
-    // Threshold HSV channels
-    // (Very expensive operation)
-    cv::inRange(frame,
-                cv::Scalar(h_min_, s_min_, v_min_),
-                cv::Scalar(h_max_, s_max_, v_max_),
-                threshold_frame_);
+    if (!filter)
+        return;
 
     // Filter the resulting threshold image
     if (erode_on_)
-        cv::erode(threshold_frame_, threshold_frame_, erode_element_);
+        morphology.erode(threshold, erode_px_);
 
     if (dilate_on_)
-        cv::dilate(threshold_frame_, threshold_frame_, dilate_element_);
+        morphology.dilate(threshold, dilate_px_);
+}
 
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-        frame.setTo(0, threshold_frame_ == 0).clone();
+bool HSVDetector::applyCoarseToFine(const cv::Mat &frame) {
+
+    // Area averaged, decimated frame
+    cv::resize(frame,
+               coarse_frame_,
+               cv::Size(frame.cols / coarse_, frame.rows / coarse_),
+               0, 0,
+               cv::INTER_AREA);
+
+    // Candidate objects. Grow them by a pixel to cover object edges that were
+    // averaged out of the pass band.
+    applyThreshold(coarse_frame_, coarse_hsv_, coarse_threshold_, morphology_, false);
+    cv::dilate(coarse_threshold_, coarse_threshold_, cv::Mat());
+
+    // Speckles too small to be objects are dropped here so that they do not
+    // take up the candidate list. There is no upper bound, since a candidate
+    // can shrink once it has been eroded at full resolution.
+    double area;
+    coarse_sifter_(coarse_threshold_,
+                   coarse_position_,
+                   area,
+                   min_object_area_ / (coarse_ * coarse_),
+                   std::numeric_limits<double>::max(),
+                   cv::Point(),
+                   &coarse_blobs_);
+
+    // Too many candidates to be sure the object is among them. Search the
+    // whole window at full resolution instead.
+    if (coarse_blobs_.size() == coarse_blobs_.capacity()) {
+
+        if (!coarse_full_warned_) {
+            std::cerr << oat::whoWarn(name(),
+                "More than " + std::to_string(coarse_blobs_.capacity())
+                + " coarse candidates. Searching at full resolution instead. "
+                  "Consider raising min_area or coarse_candidates.\n");
+            coarse_full_warned_ = true;
+        }
 
-    // Find the largest contour in the threshold image
-    siftContours(threshold_frame_,
-                 position,
-                 object_area_,
-                 min_object_area_,
-                 max_object_area_);
+        return false;
+    }
 
-    // Use the GUI tuner if requested
-    if (tuning_on_)
-        tune(frame, position);
+    // Refine candidates at full resolution, with a margin for the reach of
+    // the erode and dilate kernels
+    const int margin = coarse_
+                     + (erode_on_ ? erode_px_ : 0)
+                     + (dilate_on_ ? dilate_px_ : 0);
+    const cv::Rect full(cv::Point(0, 0), frame.size());
+
+    threshold_frame_.create(frame.size(), CV_8UC1);
+    threshold_frame_.setTo(0);
+
+    for (size_t i = 0; i < coarse_blobs_.size(); i++) {
+
+        const cv::Rect &b = coarse_blobs_[i].bounding_box;
+        cv::Rect r(b.x * coarse_ - margin,
+                   b.y * coarse_ - margin,
+                   b.width * coarse_ + 2 * margin,
+                   b.height * coarse_ + 2 * margin);
+        r &= full;
+
+        if (r.area() == 0)
+            continue;
+
+        applyThreshold(frame(r), refine_hsv_, refine_threshold_, morphology_);
+
+        // Boxes can overlap
+        cv::Mat dst = threshold_frame_(r);
+        cv::bitwise_or(dst, refine_threshold_, dst);
+    }
+
+    return true;
 }
 
 void HSVDetector::configure(const std::string &config_file,
@@ -93,6 +260,16 @@ void HSVDetector::configure(const std::string &config_file,
                                       "h_thresholds",
                                       "s_thresholds",
                                       "v_thresholds",
+                                      "lut",
+                                      "search_window",
+                                      "search_misses",
+                                      "max_blobs",
+                                      "components",
+                                      "moments",
+                                      "moments_window",
+                                      "bands",
+                                      "coarse",
+                                      "coarse_candidates",
                                       "tune" };
 
     // This will throw cpptoml::parse_exception if a file
@@ -158,6 +335,54 @@ void HSVDetector::configure(const std::string &config_file,
             v_max_ = val;
         }
 
+        // Threshold lookup table
+        oat::config::getValue(this_config, "lut", use_lut_);
+
+        // Search window
+        {
+            int64_t size = 0, misses = 10;
+            oat::config::getValue(this_config, "search_window", size, (int64_t)0);
+            oat::config::getValue(this_config, "search_misses", misses, (int64_t)1);
+            set_search_window(size, misses);
+        }
+
+        // Connected component labeling
+        oat::config::getValue(this_config, "components", use_components_);
+
+        // Single object centroid from mask moments
+        oat::config::getValue(this_config, "moments", use_moments_);
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "moments_window", val, (int64_t)0))
+                moments_window_ = val;
+        }
+
+        // Parallel bands
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "bands", val, (int64_t)0))
+                set_bands(val);
+        }
+
+        // Coarse-to-fine detection
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "coarse", val, (int64_t)1, (int64_t)16))
+                coarse_ = val;
+
+            if (oat::config::getValue(this_config, "coarse_candidates", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                coarse_blobs_.set_capacity(val);
+        }
+
+        // Number of object candidates published to the blob sink
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_blobs", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                set_max_blobs(val);
+        }
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -166,67 +391,48 @@ void HSVDetector::configure(const std::string &config_file,
     }
 }
 
-void HSVDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
+void HSVDetector::tune() {
 
-    if (!tuning_windows_created_)
+    if (!tuner_)
         createTuningWindows();
-    
-    std::string msg = cv::format("Object not found");
-
-    // Plot a circle representing found object
-    if (position.position_valid) {
-        auto radius = std::sqrt(object_area_ / PI);
-        cv::Point center;
-        center.x = position.position.x;
-        center.y = position.position.y;
-        cv::circle(frame, center, radius, cv::Scalar(0, 0, 255), 4);
-        msg = cv::format("(%d, %d) pixels",
-                (int) position.position.x,
-                (int) position.position.y);
-    }
-
-    int baseline = 0;
-    cv::Size textSize = cv::getTextSize(msg, 1, 1, 1, &baseline);
-    cv::Point text_origin(
-            frame.cols - textSize.width - 10,
-            frame.rows - 2 * baseline - 10);
-
-    cv::putText(frame, msg, text_origin, 1, 1, cv::Scalar(0, 255, 0));
 
-    cv::imshow(tuning_image_title_, frame);
-    cv::waitKey(1);
+    // Values are taken as a set, only when a slider has moved
+    if (!tuner_->update())
+        return;
+
+    h_min_ = tuner_->value(H_MIN);
+    h_max_ = tuner_->value(H_MAX);
+    s_min_ = tuner_->value(S_MIN);
+    s_max_ = tuner_->value(S_MAX);
+    v_min_ = tuner_->value(V_MIN);
+    v_max_ = tuner_->value(V_MAX);
+    set_min_object_area(tuner_->value(MIN_AREA));
+    set_max_object_area(tuner_->value(MAX_AREA));
+    set_erode_size(tuner_->value(ERODE));
+    set_dilate_size(tuner_->value(DILATE));
 }
 
 void HSVDetector::createTuningWindows() {
 
-#ifdef HAVE_OPENGL
-    try {
-        cv::namedWindow(tuning_image_title_, cv::WINDOW_OPENGL & cv::WINDOW_KEEPRATIO);
-    } catch (cv::Exception& ex) {
-        whoWarn(name_, "OpenCV not compiled with OpenGL support. Falling back to OpenCV's display driver.\n");
-        cv::namedWindow(name_, cv::WINDOW_NORMAL & cv::WINDOW_KEEPRATIO);
-    }
-#else
-    cv::namedWindow(tuning_image_title_, cv::WINDOW_NORMAL);
-#endif
+    tuner_.reset(new oat::TuningWindow(tuning_image_title_));
 
     // Create sliders and insert them into window
-    cv::createTrackbar("H MIN", tuning_image_title_, &h_min_, 256);
-    cv::createTrackbar("H MAX", tuning_image_title_, &h_max_, 256);
-    cv::createTrackbar("S MIN", tuning_image_title_, &s_min_, 256);
-    cv::createTrackbar("S MAX", tuning_image_title_, &s_max_, 256);
-    cv::createTrackbar("V MIN", tuning_image_title_, &v_min_, 256);
-    cv::createTrackbar("V MAX", tuning_image_title_, &v_max_, 256);
-    cv::createTrackbar("MIN AREA", tuning_image_title_, &dummy0_, 100000,
-            &hsvDetectorMinAreaSliderChangedCallback, this);
-    cv::createTrackbar("MAX AREA", tuning_image_title_, &dummy1_, 100000,
-            &hsvDetectorMaxAreaSliderChangedCallback, this);
-    cv::createTrackbar("ERODE", tuning_image_title_, &erode_px_, 50,
-            &hsvDetectorErodeSliderChangedCallback, this);
-    cv::createTrackbar("DILATE", tuning_image_title_, &dilate_px_, 50,
-            &hsvDetectorDilateSliderChangedCallback, this);
-
-    tuning_windows_created_ = true;
+    tuner_->addSlider("H MIN", h_min_, 256);
+    tuner_->addSlider("H MAX", h_max_, 256);
+    tuner_->addSlider("S MIN", s_min_, 256);
+    tuner_->addSlider("S MAX", s_max_, 256);
+    tuner_->addSlider("V MIN", v_min_, 256);
+    tuner_->addSlider("V MAX", v_max_, 256);
+    tuner_->addSlider("MIN AREA",
+                      static_cast<int>(std::min(min_object_area_, 100000.0)),
+                      100000);
+    tuner_->addSlider("MAX AREA",
+                      static_cast<int>(std::min(max_object_area_, 100000.0)),
+                      100000);
+    tuner_->addSlider("ERODE", erode_on_ ? erode_px_ : 0, 50);
+    tuner_->addSlider("DILATE", dilate_on_ ? dilate_px_ : 0, 50);
+
+    tuner_->start();
 }
 
 void HSVDetector::set_erode_size(int value) {
@@ -234,7 +440,6 @@ void HSVDetector::set_erode_size(int value) {
     if (value > 0) {
         erode_on_ = true;
         erode_px_ = value;
-        erode_element_ = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(erode_px_, erode_px_));
     } else {
         erode_on_ = false;
     }
@@ -244,33 +449,11 @@ void HSVDetector::set_dilate_size(int value) {
     if (value > 0) {
         dilate_on_ = true;
         dilate_px_ = value;
-        dilate_element_ = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(dilate_px_, dilate_px_));
     } else {
         dilate_on_ = false;
     }
 }
 
-// Non-member GUI callback functions
-void hsvDetectorMinAreaSliderChangedCallback(int value, void * object) {
-    auto hsv_detector = static_cast<HSVDetector *>(object);
-    hsv_detector->set_min_object_area(static_cast<double>(value));
-}
-
-void hsvDetectorMaxAreaSliderChangedCallback(int value, void * object) {
-    auto hsv_detector = static_cast<HSVDetector *>(object);
-    hsv_detector->set_max_object_area(static_cast<double>(value));
-}
-
-void hsvDetectorErodeSliderChangedCallback(int value, void * object) {
-    auto hsv_detector = static_cast<HSVDetector *>(object);
-    hsv_detector->set_erode_size(value);
-}
-
-void hsvDetectorDilateSliderChangedCallback(int value, void * object) {
-    auto hsv_detector = static_cast<HSVDetector *>(object);
-    hsv_detector->set_dilate_size(value);
-}
-
 } /* namespace oat */
 
 // NOTE: This code was from a leftover functional CUDA implementation that did not
@@ -24,6 +24,8 @@
 
 #include <string>
 #include <limits>
+#include <memory>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 #ifdef NOIMP_OAT_USE_CUDA
 #include <opencv2/cudaarithm.hpp>
@@ -31,7 +33,14 @@
 #include <opencv2/cudaimgproc.hpp>
 #endif
 
+#include "../../lib/datatypes/Blobs2D.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/TuningWindow.h"
+
+#include "ComponentSifter.h"
+#include "HSVThreshold.h"
 #include "PositionDetector.h"
+#include "RectMorphology.h"
 
 namespace oat {
 
@@ -74,31 +83,62 @@ private:
     bool erode_on_ {false}, dilate_on_ {false};
 
     // Internal matricies
-    cv::Mat threshold_frame_, erode_element_, dilate_element_;
+    cv::Mat threshold_frame_;
+
+    // Erode and dilate in constant time per pixel
+    oat::RectMorphology morphology_;
+
+    // Per band HSV and threshold buffers when detecting in parallel bands
+    std::vector<cv::Mat> band_hsv_, band_threshold_;
+    std::vector<oat::RectMorphology> band_morphology_;
+
+    // Threshold and filter a BGR frame. hsv holds the HSV conversion when the
+    // lookup table is not used, and can be the input frame to convert in
+    // place.
+    void applyThreshold(const cv::Mat &frame,
+                        cv::Mat &hsv,
+                        cv::Mat &threshold,
+                        oat::RectMorphology &morphology,
+                        const bool filter = true) const;
+
+    // Coarse-to-fine detection. The frame is thresholded at 1/coarse_
+    // resolution to find candidate objects, and then only their bounding
+    // boxes are thresholded and filtered at full resolution. Objects must
+    // cover about coarse_ x coarse_ pixels to survive the decimation.
+    // Returns false, without refining, if there were more candidates than
+    // coarse_blobs_ can hold.
+    int coarse_ {1};
+    bool coarse_full_warned_ {false};
+    cv::Mat coarse_frame_, coarse_hsv_, coarse_threshold_;
+    cv::Mat refine_hsv_, refine_threshold_;
+    oat::ComponentSifter coarse_sifter_;
+    oat::Blobs2D coarse_blobs_ {"coarse"};
+    oat::Position2D coarse_position_ {"coarse"};
+    bool applyCoarseToFine(const cv::Mat &frame);
 
     // HSV threshold values
     int h_min_ {0}, h_max_ {256};
     int s_min_ {0}, s_max_ {256};
     int v_min_ {0}, v_max_ {256};
-    int dummy0_ {0}, dummy1_ {100000};
+
+    // Threshold BGR frames using a precomputed table instead of converting
+    // them to HSV. The table is not used while tuning.
+    bool use_lut_ {true};
+    bool lut_on_ {false};
+    oat::HSVThreshold hsv_threshold_;
+    cv::Mat hsv_frame_;
 
     // Detect object area
     double object_area_ {0.0};
     double min_object_area_ {0.0};
     double max_object_area_ {std::numeric_limits<double>::max()};
 
-    // Parameter tuning GUI functions and properties
+    // Parameter tuning GUI, run on its own thread
     const std::string tuning_image_title_;
-    void tune(cv::Mat &frame, const oat::Position2D &position);
+    std::unique_ptr<oat::TuningWindow> tuner_;
+    void tune(void);
     void createTuningWindows(void);
-
 };
 
-// Tuning GUI callbacks
-void hsvDetectorMinAreaSliderChangedCallback(int value, void *);
-void hsvDetectorMaxAreaSliderChangedCallback(int value, void *);
-void hsvDetectorErodeSliderChangedCallback(int value, void *);
-void hsvDetectorDilateSliderChangedCallback(int value, void *);
-
 }       /* namespace oat */
 #endif	/* OAT_HSVDETECTOR_H */
@@ -0,0 +1,87 @@
+//******************************************************************************
+//* File:   HSVThreshold.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
+
+#include "HSVClassifier.h"
+#include "HSVThreshold.h"
+
+namespace oat {
+
+void HSVThreshold::set(const cv::Scalar &min, const cv::Scalar &max) {
+
+    if (built_ && min == min_ && max == max_)
+        return;
+
+    min_ = min;
+    max_ = max;
+    build();
+}
+
+void HSVThreshold::build() {
+
+    table_.assign((1 << 24) / 64, 0);
+
+    cv::Mat mask;
+    forEachHSVSlice([this, &mask](int b, const cv::Mat &hsv) {
+
+        cv::inRange(hsv, min_, max_, mask);
+
+        // Each row of the slice is 256 consecutive table bits
+        for (int g = 0; g < 256; g++) {
+            const auto *m = mask.ptr<uint8_t>(g);
+            uint64_t *w = &table_[((b << 16) | (g << 8)) >> 6];
+            for (int r = 0; r < 256; r++)
+                w[r >> 6] |= static_cast<uint64_t>(m[r] & 1) << (r & 63);
+        }
+    });
+
+    built_ = true;
+}
+
+void HSVThreshold::apply(const cv::Mat &frame, cv::Mat &mask) const {
+
+    if (frame.type() != CV_8UC3)
+        throw std::runtime_error("HSV thresholding requires 8-bit BGR frames.");
+
+    mask.create(frame.size(), CV_8UC1);
+
+    const uint64_t *table = table_.data();
+
+    int rows = frame.rows;
+    int cols = frame.cols;
+    if (frame.isContinuous() && mask.isContinuous()) {
+        cols *= rows;
+        rows = 1;
+    }
+
+    for (int i = 0; i < rows; i++) {
+
+        const uint8_t *p = frame.ptr<uint8_t>(i);
+        uint8_t *m = mask.ptr<uint8_t>(i);
+
+        for (int j = 0; j < cols; j++, p += 3) {
+            const uint32_t c = (p[0] << 16) | (p[1] << 8) | p[2];
+            m[j] = -static_cast<uint8_t>((table[c >> 6] >> (c & 63)) & 1);
+        }
+    }
+}
+
+}       /* namespace oat */
@@ -0,0 +1,69 @@
+//******************************************************************************
+//* File:   HSVThreshold.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_HSVTHRESHOLD_H
+#define	OAT_HSVTHRESHOLD_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * HSV pass band threshold applied directly to BGR frames. The result of
+ * converting every 24-bit BGR color to HSV and testing it against the pass
+ * band is precomputed into a 2 MB bit table when the thresholds change, so
+ * that thresholding a frame is a single lookup per pixel with no HSV
+ * intermediate. Results are identical to cv::cvtColor(COLOR_BGR2HSV)
+ * followed by cv::inRange.
+ */
+class HSVThreshold {
+
+public:
+
+    /**
+     * @brief Set the HSV pass band. The lookup table is only rebuilt if it
+     * differs from the current one.
+     * @param min Inclusive lower H, S and V bounds.
+     * @param max Inclusive upper H, S and V bounds.
+     */
+    void set(const cv::Scalar &min, const cv::Scalar &max);
+
+    /**
+     * @brief Threshold a frame.
+     * @param frame 8-bit BGR frame.
+     * @param mask 8-bit mask, 255 where the frame is inside the pass band and
+     * 0 elsewhere. Reallocated only if its size or type differ.
+     */
+    void apply(const cv::Mat &frame, cv::Mat &mask) const;
+
+private:
+
+    cv::Scalar min_, max_;
+    bool built_ {false};
+
+    // One bit per BGR color, indexed by (B << 16) | (G << 8) | R
+    std::vector<uint64_t> table_;
+
+    void build(void);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_HSVTHRESHOLD_H */
@@ -0,0 +1,69 @@
+//******************************************************************************
+//* File:   MotionGate.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "MotionGate.h"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+namespace oat {
+
+bool MotionGate::operator()(const cv::Mat &frame) {
+
+    if (!enabled())
+        return true;
+
+    cv::resize(frame,
+               small_,
+               cv::Size(std::max(frame.cols / MOTION_GATE_DECIMATION, 1),
+                        std::max(frame.rows / MOTION_GATE_DECIMATION, 1)),
+               0, 0,
+               cv::INTER_AREA);
+
+    if (small_.channels() == 3)
+        cv::cvtColor(small_, gray_, cv::COLOR_BGR2GRAY);
+    else
+        small_.copyTo(gray_);
+
+    bool open = !has_reference_
+             || (max_hold_ > 0 && held_ >= max_hold_)
+             || gray_.size() != reference_.size();
+
+    // Largest block change, so that motion of a small object in a large
+    // frame is not averaged away
+    if (!open) {
+        double max_change;
+        cv::absdiff(gray_, reference_, diff_);
+        cv::minMaxLoc(diff_, nullptr, &max_change);
+        open = max_change > threshold_;
+    }
+
+    if (!open) {
+        held_++;
+        return false;
+    }
+
+    std::swap(gray_, reference_);
+    has_reference_ = true;
+    held_ = 0;
+
+    return true;
+}
+
+} /* namespace oat */
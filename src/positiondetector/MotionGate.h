@@ -0,0 +1,76 @@
+//******************************************************************************
+//* File:   MotionGate.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_MOTIONGATE_H
+#define	OAT_MOTIONGATE_H
+
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+// Constants
+static constexpr int MOTION_GATE_DECIMATION {8};
+
+/**
+ * Decides whether a frame has changed enough since the last detection to be
+ * worth detecting again. Frames are reduced to a grayscale image of block
+ * means, decimated by MOTION_GATE_DECIMATION, and compared to the reduced
+ * image of the last frame that was let through. Comparing against that
+ * frame, rather than the previous one, keeps slow drift from being missed.
+ * Buffers are reused between frames.
+ */
+class MotionGate {
+
+public:
+
+    /**
+     * @brief Set the gate threshold.
+     * @param threshold Block mean intensity change (0-255) that opens the
+     * gate. 0 disables the gate.
+     */
+    void set_threshold(const int threshold) { threshold_ = threshold; }
+
+    /**
+     * @brief Limit the number of consecutive frames that are held back.
+     * @param max_hold Maximum consecutive closed frames. 0 for no limit.
+     */
+    void set_max_hold(const int max_hold) { max_hold_ = max_hold; }
+
+    bool enabled(void) const { return threshold_ > 0; }
+
+    /**
+     * @brief Test a frame. A frame that passes becomes the new reference.
+     * @param frame Frame to test.
+     * @return True if the frame should be detected: the gate is disabled,
+     * this is the first frame, the hold limit is reached, or some block
+     * changed by more than the threshold.
+     */
+    bool operator()(const cv::Mat &frame);
+
+private:
+
+    int threshold_ {0};
+    int max_hold_ {0};
+    int held_ {0};
+    bool has_reference_ {false};
+    cv::Mat small_, gray_, reference_, diff_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_MOTIONGATE_H */
@@ -0,0 +1,190 @@
+//******************************************************************************
+//* File:   MultiHSVDetector.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <map>
+#include <string>
+#include <opencv2/core/mat.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/TOMLSanitize.h"
+
+#include "MultiHSVDetector.h"
+
+namespace oat {
+
+MultiHSVDetector::MultiHSVDetector(const std::string &frame_source_address,
+                                   const std::string &position_sink_address) :
+  PositionDetector(frame_source_address, position_sink_address)
+{
+    // Nothing
+}
+
+void MultiHSVDetector::connectToNode() {
+
+    if (names_.empty())
+        throw (std::runtime_error("At least one target must be configured.\n"));
+
+    PositionDetector::connectToNode();
+}
+
+void MultiHSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
+
+    position.position_valid = false;
+
+    // Classify each pixel once for all targets
+    classifier_.apply(frame(search_roi_), masks_);
+
+    for (size_t i = 0; i < masks_.size(); i++) {
+
+        if (erode_px_ > 0)
+            morphology_.erode(masks_[i], erode_px_);
+
+        if (dilate_px_ > 0)
+            morphology_.dilate(masks_[i], dilate_px_);
+
+        double area;
+        siftObjects(masks_[i],
+                    object_positions_[i],
+                    area,
+                    min_object_area_,
+                    max_object_area_,
+                    object_blobs(i));
+    }
+}
+
+void MultiHSVDetector::configure(const std::string &config_file,
+                                 const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"targets",
+                                      "erode",
+                                      "dilate",
+                                      "min_area",
+                                      "max_area",
+                                      "components",
+                                      "max_blobs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Targets, ordered by name
+        oat::config::Table targets;
+        if (!oat::config::getTable(this_config, "targets", targets))
+            throw (std::runtime_error("Required configuration value 'targets' "
+                                      "was not specified.\n"));
+
+        std::map<std::string, oat::config::Table> sorted;
+        for (const auto &t : *targets) {
+            if (!t.second->is_table())
+                throw (std::runtime_error("Target '" + t.first
+                                          + "' must be a TOML table.\n"));
+            sorted[t.first] = targets->get_table(t.first);
+        }
+
+        if (sorted.empty() || sorted.size() > MAX_HSV_CLASSES)
+            throw (std::runtime_error("Between 1 and "
+                                      + std::to_string(MAX_HSV_CLASSES)
+                                      + " targets must be specified.\n"));
+
+        names_.clear();
+        min_.clear();
+        max_.clear();
+
+        const std::vector<std::string> target_options {"h_thresholds",
+                                                       "s_thresholds",
+                                                       "v_thresholds"};
+
+        for (const auto &t : sorted) {
+
+            oat::config::checkKeys(target_options, t.second);
+
+            // HSV thresholds, defaulting to the full range
+            int min[3] {0, 0, 0}, max[3] {256, 256, 256};
+            for (int c = 0; c < 3; c++) {
+
+                oat::config::Table band;
+                if (oat::config::getTable(t.second, target_options[c], band)) {
+
+                    int64_t val;
+                    oat::config::getValue(band, "min", val, (int64_t)0, (int64_t)256, true);
+                    min[c] = val;
+                    oat::config::getValue(band, "max", val, (int64_t)0, (int64_t)256, true);
+                    max[c] = val;
+                }
+            }
+
+            names_.push_back(t.first);
+            min_.push_back(cv::Scalar(min[0], min[1], min[2]));
+            max_.push_back(cv::Scalar(max[0], max[1], max[2]));
+        }
+
+        classifier_.set(min_, max_);
+        set_objects(names_);
+
+        // Erode
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "erode", val, (int64_t)0))
+                erode_px_ = val;
+        }
+
+        // Dilate
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "dilate", val, (int64_t)0))
+                dilate_px_ = val;
+        }
+
+        // Minimum object area
+        oat::config::getValue(this_config, "min_area", min_object_area_, 0.0);
+
+        // Maximum object area
+        oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
+
+        // Connected component labeling
+        oat::config::getValue(this_config, "components", use_components_);
+
+        // Number of object candidates published to the blob sink
+        {
+            int64_t val;
+            if (oat::config::getValue(this_config, "max_blobs", val,
+                                      (int64_t)1, (int64_t)MAX_BLOBS))
+                set_max_blobs(val);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,84 @@
+//******************************************************************************
+//* File:   MultiHSVDetector.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_MULTIHSVDETECTOR_H
+#define	OAT_MULTIHSVDETECTOR_H
+
+#include <string>
+#include <limits>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "HSVClassifier.h"
+#include "PositionDetector.h"
+#include "RectMorphology.h"
+
+namespace oat {
+
+// Forward decl.
+class Position2D;
+
+/**
+ * A color-based detector for several objects of different colors (e.g. the
+ * two LEDs of a head stage). Each frame is classified against the HSV pass
+ * band of every target in a single pass, and each target's position is
+ * published to its own SINK, SINK_<target>.
+ */
+class MultiHSVDetector : public PositionDetector {
+public:
+
+    /**
+     * A color-based detector for several objects.
+     * @param frame_source_address Frame SOURCE node address
+     * @param position_sink_address Position SINK node address prefix
+     */
+    MultiHSVDetector(const std::string &frame_source_address,
+                     const std::string &position_sink_address);
+
+    void connectToNode(void) override;
+
+    /**
+     * Detect the position of each target.
+     * @param Frame to look for targets within.
+     * @param position Not used.
+     */
+    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    // Target names and HSV pass bands
+    std::vector<std::string> names_;
+    std::vector<cv::Scalar> min_, max_;
+
+    // Filtering, shared by all targets
+    int erode_px_ {0}, dilate_px_ {10};
+    double min_object_area_ {0.0};
+    double max_object_area_ {std::numeric_limits<double>::max()};
+
+    // One mask per target, filled in a single pass
+    oat::HSVClassifier classifier_;
+    std::vector<cv::Mat> masks_;
+    oat::RectMorphology morphology_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_MULTIHSVDETECTOR_H */
@@ -17,6 +17,8 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <chrono>
+#include <stdexcept>
 #include <string>
 #include <opencv2/core/mat.hpp>
 
@@ -25,6 +27,7 @@
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 
+#include "DetectorFunc.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -38,6 +41,16 @@ PositionDetector::PositionDetector(const std::string &frame_source_address,
   // Nothing
 }
 
+PositionDetector::~PositionDetector() {
+
+    // Stop acquisition thread
+    if (acquire_thread_.joinable()) {
+        acquiring_ = false;
+        ring_cv_.notify_all();
+        acquire_thread_.join();
+    }
+}
+
 void PositionDetector::connectToNode() {
 
     // Establish our a slot in the node
@@ -46,13 +59,132 @@ void PositionDetector::connectToNode() {
     // Wait for synchronous start with sink when it binds the node
     frame_source_.connect();
 
-    // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
-    shared_position_ = position_sink_.retrieve();
+    // Arena detectors publish in place of this one
+    if (arenas_.empty()) {
+        bindSinks();
+    } else {
+        for (auto &a : arenas_)
+            a->bindSinks();
+    }
+
+    // Start acquisition thread
+    if (pipeline_depth_ > 0) {
+
+        ring_.resize(pipeline_depth_);
+        ring_free_.reset(new boost::lockfree::spsc_queue<size_t>(pipeline_depth_));
+        ring_full_.reset(new boost::lockfree::spsc_queue<size_t>(pipeline_depth_));
+        for (size_t i = 0; i < pipeline_depth_; i++)
+            ring_free_->push(i);
+
+        acquiring_ = true;
+        acquire_thread_ = std::thread(&PositionDetector::acquire, this);
+    }
+}
+
+void PositionDetector::bindSinks() {
+
+    // Bind to sink nodes and create shared positions, one per named object
+    // if there are any
+    if (object_sink_addresses_.empty()) {
+        position_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_position_ = position_sink_.retrieve();
+    }
+
+    for (const auto &a : object_sink_addresses_) {
+        object_sinks_.emplace_back(new oat::Sink<oat::Position2D>());
+        object_sinks_.back()->bind(a, a);
+        shared_objects_.push_back(object_sinks_.back()->retrieve());
+    }
+
+    // Bind to blob list sink nodes if requested, one per named object if
+    // there are any
+    if (blob_sink_address_.empty())
+        return;
+
+    if (object_blobs_.empty()) {
+        blob_sink_.bind(blob_sink_address_, blob_sink_address_);
+        shared_blobs_ = blob_sink_.retrieve();
+    }
+
+    for (auto &b : object_blobs_) {
+        const std::string a = blob_sink_address_ + "_" + b.label();
+        object_blob_sinks_.emplace_back(new oat::Sink<oat::Blobs2D>());
+        object_blob_sinks_.back()->bind(a, a);
+        shared_object_blobs_.push_back(object_blob_sinks_.back()->retrieve());
+    }
+}
+
+void PositionDetector::set_objects(const std::vector<std::string> &names) {
+
+    object_sink_addresses_.clear();
+    object_positions_.clear();
+    object_blobs_.clear();
+
+    for (const auto &n : names) {
+        object_sink_addresses_.push_back(position_sink_address_ + "_" + n);
+        object_positions_.emplace_back(n);
+        object_blobs_.emplace_back(n);
+        object_blobs_.back().set_capacity(internal_blobs_.capacity());
+    }
+}
+
+void PositionDetector::add_arena(std::shared_ptr<PositionDetector> detector,
+                                 const cv::Rect &roi) {
+
+    if (roi.area() <= 0)
+        throw (std::runtime_error("Arena " + detector->position_sink_address_
+                                  + " is empty.\n"));
+
+    // Detectors may modify the frame within their search window
+    for (const auto &a : arenas_) {
+        if ((a->bounds_ & roi).area() > 0)
+            throw (std::runtime_error("Arena " + detector->position_sink_address_
+                                      + " overlaps arena "
+                                      + a->position_sink_address_ + ".\n"));
+    }
+
+    detector->bounds_ = roi;
+    arenas_.push_back(detector);
 }
 
 bool PositionDetector::process() {
 
+    if (pipeline_depth_ > 0) {
+
+        // Wait briefly for the acquisition thread to fill a slot, so that
+        // the caller can check for interruption
+        size_t i;
+        if (!ring_full_->pop(i)) {
+
+            std::unique_lock<std::mutex> lk(ring_mutex_);
+            ring_cv_.wait_for(lk, std::chrono::milliseconds(10), [this] {
+                return ring_full_->read_available() > 0 || source_eof_;
+            });
+            lk.unlock();
+
+            // Frames acquired before the SOURCE ended are still published
+            const bool eof = source_eof_;
+            if (!ring_full_->pop(i)) {
+
+                if (!eof)
+                    return false;
+
+                if (acquire_error_)
+                    std::rethrow_exception(acquire_error_);
+
+                return true;
+            }
+        }
+
+        dispatch(ring_[i]);
+
+        // Return the slot to the acquisition thread
+        ring_free_->push(i);
+        ring_cv_.notify_all();
+
+        return false;
+    }
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
@@ -69,26 +201,251 @@ bool PositionDetector::process() {
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
+    dispatch(internal_frame_);
+
+    // Sink was not at END state
+    return false;
+}
+
+void PositionDetector::dispatch(oat::Frame &frame) {
+
+    if (arenas_.empty()) {
+        detectAndPublish(frame);
+        return;
+    }
+
+    // Checked here because exceptions cannot leave the parallel loop
+    const cv::Rect full(cv::Point(0, 0), frame.size());
+    for (const auto &a : arenas_) {
+        if ((a->bounds_ & full).area() == 0)
+            throw (std::runtime_error("Arena " + a->position_sink_address_
+                                      + " lies outside of the frame.\n"));
+    }
+
+    const int n = static_cast<int>(arenas_.size());
+    oat::parallelBands(n, n, [this, &frame](int b, const cv::Range &) {
+        arenas_[b]->detectAndPublish(frame);
+    });
+}
+
+void PositionDetector::detectAndPublish(oat::Frame &frame) {
+
     // Propagate sample info and detect position
-    internal_position_.sample() = internal_frame_.sample_copy();
-    detectPosition(internal_frame_, internal_position_);
+    internal_position_.sample() = frame.sample_copy();
+    internal_blobs_.sample() = frame.sample_copy();
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    const cv::Rect region = bounds(frame.size());
 
-    // Wait for sources to read
-    position_sink_.wait();
+    for (auto &p : object_positions_)
+        p.sample() = frame.sample_copy();
 
-    *shared_position_ = internal_position_;
+    for (auto &b : object_blobs_)
+        b.sample() = frame.sample_copy();
 
-    // Tell sources there is new data
-    position_sink_.post();
+    // Static frames repeat the previous result
+    const bool detect = tuning_on_ || motion_gate_(frame(region));
+    if (detect) {
+        internal_blobs_.clear();
+        for (auto &b : object_blobs_)
+            b.clear();
+        search_roi_ = searchWindow(frame.size());
+        detectPosition(frame, internal_position_);
+        updateSearchWindow(internal_position_);
+    }
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+    internal_position_.position_held = !detect;
+    for (auto &p : object_positions_)
+        p.position_held = !detect;
 
-    // Sink was not at END state
-    return false;
+    if (object_sinks_.empty()) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_sink_.wait();
+
+        *shared_position_ = internal_position_;
+
+        // Tell sources there is new data
+        position_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    for (size_t i = 0; i < object_sinks_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        object_sinks_[i]->wait();
+
+        *shared_objects_[i] = object_positions_[i];
+
+        object_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    if (shared_blobs_ != nullptr) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        blob_sink_.wait();
+
+        *shared_blobs_ = internal_blobs_;
+
+        blob_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    for (size_t i = 0; i < object_blob_sinks_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        object_blob_sinks_[i]->wait();
+
+        *shared_object_blobs_[i] = object_blobs_[i];
+
+        object_blob_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+}
+
+void PositionDetector::acquire() {
+
+    try {
+
+        while (acquiring_) {
+
+            // Hold the SOURCE until a slot is free so that frames are not
+            // dropped
+            size_t i;
+            if (!ring_free_->pop(i)) {
+                std::unique_lock<std::mutex> lk(ring_mutex_);
+                ring_cv_.wait_for(lk, std::chrono::milliseconds(10), [this] {
+                    return ring_free_->read_available() > 0 || !acquiring_;
+                });
+                continue;
+            }
+
+            // START CRITICAL SECTION //
+            ////////////////////////////
+
+            // Wait for sink to write to node
+            if (frame_source_.wait() == oat::NodeState::END)
+                break;
+
+            // Copy the shared frame. Slots keep their allocation.
+            frame_source_.copyTo(ring_[i]);
+
+            // Tell sink it can continue
+            frame_source_.post();
+
+            ////////////////////////////
+            //  END CRITICAL SECTION  //
+
+            ring_full_->push(i);
+            ring_cv_.notify_all();
+        }
+
+    } catch (...) {
+        acquire_error_ = std::current_exception();
+    }
+
+    source_eof_ = true;
+    ring_cv_.notify_all();
+}
+
+void PositionDetector::siftObjects(cv::Mat &mask,
+                                   oat::Position2D &position,
+                                   double &area,
+                                   double min_area,
+                                   double max_area,
+                                   oat::Blobs2D *candidates) {
+
+    if (use_moments_)
+        maskCentroid(mask, position, area, min_area, max_area,
+                     moments_window_, bands_, search_roi_.tl(), candidates);
+    else if (use_components_)
+        component_sifter_(mask, position, area, min_area, max_area,
+                          search_roi_.tl(), candidates);
+    else
+        siftContours(mask, position, area, min_area, max_area,
+                     search_roi_.tl(), candidates);
+}
+
+void PositionDetector::set_search_window(const int size, const int max_misses) {
+
+    search_window_ = size;
+    search_max_misses_ = max_misses;
+    search_last_valid_ = false;
+}
+
+cv::Rect PositionDetector::bounds(const cv::Size &frame_size) const {
+
+    cv::Rect full(cv::Point(0, 0), frame_size);
+    if (bounds_.area() > 0)
+        full &= bounds_;
+
+    return full;
+}
+
+cv::Rect PositionDetector::searchWindow(const cv::Size &frame_size) const {
+
+    const cv::Rect full = bounds(frame_size);
+
+    if (search_window_ <= 0 || tuning_on_ || !search_last_valid_)
+        return full;
+
+    // Constant velocity prediction, extrapolated over missed frames
+    cv::Point2d center = search_last_;
+    if (search_velocity_valid_)
+        center += search_velocity_ * (search_misses_ + 1);
+
+    const int half = search_window_ / 2;
+    cv::Rect window(static_cast<int>(center.x) - half,
+                    static_cast<int>(center.y) - half,
+                    search_window_,
+                    search_window_);
+    window &= full;
+
+    return window.area() > 0 ? window : full;
+}
+
+void PositionDetector::updateSearchWindow(const oat::Position2D &position) {
+
+    if (search_window_ <= 0)
+        return;
+
+    if (position.position_valid) {
+
+        cv::Point2d p(position.position.x, position.position.y);
+
+        // Velocity is only known across consecutive detections
+        search_velocity_valid_ = search_last_valid_ && search_misses_ == 0;
+        if (search_velocity_valid_)
+            search_velocity_ = p - search_last_;
+
+        search_last_ = p;
+        search_last_valid_ = true;
+        search_misses_ = 0;
+
+    } else if (search_last_valid_ && ++search_misses_ >= search_max_misses_) {
+
+        // Fall back to full frame search until the object is found again
+        search_last_valid_ = false;
+        search_velocity_valid_ = false;
+        search_misses_ = 0;
+    }
 }
 
 } /* namespace oat */
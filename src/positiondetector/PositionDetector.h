@@ -20,13 +20,27 @@
 #ifndef OAT_POSITIONDETECTOR_H
 #define	OAT_POSITIONDETECTOR_H
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <opencv2/core/types.hpp>
 
+#include "../../lib/datatypes/Blobs2D.h"
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 
+#include "BandParallel.h"
+#include "ComponentSifter.h"
+#include "MotionGate.h"
+
 namespace oat {
 
 // Forward decl.
@@ -48,7 +62,7 @@ public:
     PositionDetector(const std::string &frame_source_address,
                      const std::string &position_sink_address);
 
-    virtual ~PositionDetector() { }
+    virtual ~PositionDetector();
 
     /**
      * PositionDetectors must be able to connect to a Source and Sink
@@ -58,11 +72,52 @@ public:
 
     /**
      * Obtain frame from SOURCE. Detect object position within the frame. Publish
-     * detected position to SINK.
+     * detected position to SINK. When pipelined, frames are obtained by a
+     * separate thread, and this returns without publishing if no frame
+     * arrives within a short timeout.
      * @return SOURCE end-of-stream signal. If true, this component should exit.
      */
     virtual bool process(void);
 
+    /**
+     * Overlap frame acquisition with detection. An acquisition thread copies
+     * frames from the SOURCE into a ring of preallocated frames, releasing
+     * the SOURCE immediately, while process() detects and publishes
+     * positions from the ring in order. Must be called before connectToNode.
+     * @param depth Number of frames in the ring. 0 to acquire and detect
+     * serially.
+     */
+    void set_pipeline_depth(const size_t depth) { pipeline_depth_ = depth; }
+
+    /**
+     * Skip detection on frames that have not changed since the last detected
+     * frame. The previous position is published again, with the new sample
+     * number and position_held set. Never skips while tuning.
+     * @param threshold Block mean intensity change (0-255) of a decimated
+     * grayscale frame above which detection is performed. 0 to detect on
+     * every frame.
+     * @param max_hold Maximum number of consecutive frames that are skipped.
+     * 0 for no limit.
+     */
+    void set_motion_gate(const int threshold, const int max_hold) {
+        motion_gate_.set_threshold(threshold);
+        motion_gate_.set_max_hold(max_hold);
+    }
+
+    /**
+     * Detect within several regions (arenas) of each frame instead of the
+     * whole frame. Each arena is searched by its own detector, which
+     * publishes to its own SINKs, while frames are acquired once by this
+     * detector and its own SINKs are not used. Arenas are processed in
+     * parallel. Must be called before connectToNode.
+     * @param detector Configured detector for the arena. Its SOURCE is not
+     * used.
+     * @param roi Region of the frame searched by the detector. Positions are
+     * still reported in full frame coordinates.
+     */
+    void add_arena(std::shared_ptr<PositionDetector> detector,
+                   const cv::Rect &roi);
+
     /**
      * Configure filter parameters.
      * @param config_file configuration file path
@@ -75,6 +130,45 @@ public:
     std::string name(void) const { return name_; }
     void tuning_on(const bool value)  { tuning_on_ = value; }
 
+    /**
+     * Limit detection to a square window, centered on the position predicted
+     * from previous detections.
+     * @param size Window side length in pixels. 0 to search the full frame.
+     * @param max_misses Number of consecutive frames without a detection
+     * after which the full frame is searched again.
+     */
+    void set_search_window(const int size, const int max_misses);
+
+    /**
+     * In addition to the position of the largest object, publish a list of
+     * the largest object candidates, found in the same pass, to a second SINK.
+     * Detectors with named objects publish one list per object, to
+     * BLOB_SINK_<name>.
+     * @param blob_sink_address Blob list SINK node address
+     */
+    void set_blob_sink(const std::string &blob_sink_address) {
+        blob_sink_address_ = blob_sink_address;
+    }
+
+    /**
+     * Maximum number of object candidates published to the blob SINK.
+     */
+    void set_max_blobs(const size_t k) {
+        internal_blobs_.set_capacity(k);
+        for (auto &b : object_blobs_)
+            b.set_capacity(k);
+    }
+
+    /**
+     * Split detection into horizontal bands that are processed in parallel.
+     * @param bands Number of bands. 1 to process on a single thread, 0 for
+     * one band per OpenCV worker thread.
+     */
+    void set_bands(const int bands) {
+        bands_ = oat::resolveBands(bands);
+        component_sifter_.set_bands(bands_);
+    }
+
 protected:
 
     /**
@@ -83,16 +177,128 @@ protected:
      * @param position Detected object position.
      */
     virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
+
+    // Region of the frame that detectPosition should search. Positions are
+    // still reported in full frame coordinates. Always the full frame when
+    // tuning, so that the whole frame can be inspected.
+    cv::Rect search_roi_;
+
+    // Region of the frame this detector is confined to: its arena, or the
+    // full frame. search_roi_ always lies within it.
+    cv::Rect bounds(const cv::Size &frame_size) const;
+
+    // Object candidate list to be filled by detectPosition, or nullptr if
+    // blobs are not being published.
+    oat::Blobs2D * blobs(void) {
+        return blob_sink_address_.empty() ? nullptr : &internal_blobs_;
+    }
+
+    // Candidate list of the i-th named object, or nullptr if blobs are not
+    // being published.
+    oat::Blobs2D * object_blobs(const size_t i) {
+        return blob_sink_address_.empty() ? nullptr : &object_blobs_[i];
+    }
+
+    /**
+     * Find the largest object within an area range in a binary mask of the
+     * search window and, if requested, collect candidates into blobs().
+     * Uses siftContours or, if use_components_ is set, a single pass
+     * connected component labeler. If use_moments_ is set, the centroid of
+     * all foreground pixels is used instead. The mask may be modified.
+     */
+    void siftObjects(cv::Mat &mask,
+                     oat::Position2D &position,
+                     double &area,
+                     double min_area,
+                     double max_area) {
+        siftObjects(mask, position, area, min_area, max_area, blobs());
+    }
+
+    /**
+     * As above, collecting candidates into the given list instead.
+     * @param candidates Candidate list, or nullptr to skip collection.
+     */
+    void siftObjects(cv::Mat &mask,
+                     oat::Position2D &position,
+                     double &area,
+                     double min_area,
+                     double max_area,
+                     oat::Blobs2D *candidates);
+
+    /**
+     * For detectors that find several distinct objects in each frame:
+     * replace the position SINK with one SINK per named object, named
+     * SINK_<name>. detectPosition must then fill object_positions_, in the
+     * order of names, instead of its position argument, and pass
+     * object_blobs(i) to siftObjects. Must be called before connectToNode.
+     * @param names Object names.
+     */
+    void set_objects(const std::vector<std::string> &names);
+
+    // Positions of named objects, published to their own SINKs
+    std::vector<oat::Position2D> object_positions_;
+
+    // Label connected components instead of tracing contours
+    bool use_components_ {false};
+
+    // Take the centroid of the whole mask instead of finding objects, with
+    // an optional second pass in a window around the first estimate
+    bool use_moments_ {false};
+    int moments_window_ {0};
+
+    // Number of horizontal bands processed in parallel
+    int bands_ {1};
     
     // Detector name
     const std::string name_;
 
     // Use GUI to tune detection parameters
     bool tuning_on_ {false};
-    bool tuning_windows_created_ {false};
 
 private:
 
+    // Search window
+    int search_window_ {0};
+    int search_max_misses_ {0};
+    int search_misses_ {0};
+    bool search_last_valid_ {false};
+    bool search_velocity_valid_ {false};
+    cv::Point2d search_last_, search_velocity_;
+    cv::Rect searchWindow(const cv::Size &frame_size) const;
+    void updateSearchWindow(const oat::Position2D &position);
+
+    // Detect position in a frame and publish the result
+    void detectAndPublish(oat::Frame &frame);
+
+    // Detect in this detector or, in parallel, in each arena
+    void dispatch(oat::Frame &frame);
+
+    // Arenas. Arena detectors only search within their bounds_.
+    cv::Rect bounds_;
+    std::vector<std::shared_ptr<PositionDetector>> arenas_;
+
+    // Bind position and blob SINKs
+    void bindSinks(void);
+
+    // Skips detection on static frames
+    oat::MotionGate motion_gate_;
+
+    // Pipelined acquisition. Ring slot indices circulate between the free
+    // and full queues.
+    size_t pipeline_depth_ {0};
+    std::vector<oat::Frame> ring_;
+    std::unique_ptr<boost::lockfree::spsc_queue<size_t>> ring_free_, ring_full_;
+    std::mutex ring_mutex_;
+    std::condition_variable ring_cv_;
+    std::thread acquire_thread_;
+    std::atomic<bool> acquiring_ {false};
+    std::atomic<bool> source_eof_ {false};
+    std::exception_ptr acquire_error_;
+    void acquire(void);
+
+    // Reusable connected component labeler
+    oat::ComponentSifter component_sifter_;
+
     // Current frame
     oat::Frame internal_frame_;
     oat::Position2D internal_position_ {"internal"};
@@ -106,6 +312,22 @@ private:
     const std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
 
+    // Blob list sink (optional)
+    std::string blob_sink_address_;
+    oat::Blobs2D internal_blobs_ {"internal"};
+    oat::Blobs2D * shared_blobs_ {nullptr};
+    oat::Sink<oat::Blobs2D> blob_sink_;
+
+    // Named object sinks (optional), replacing the position sink
+    std::vector<std::string> object_sink_addresses_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Position2D>>> object_sinks_;
+    std::vector<oat::Position2D *> shared_objects_;
+
+    // Named object blob list sinks (optional), replacing the blob list sink
+    std::vector<oat::Blobs2D> object_blobs_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Blobs2D>>> object_blob_sinks_;
+    std::vector<oat::Blobs2D *> shared_object_blobs_;
+
 };
 
 }      /* namespace oat */
@@ -0,0 +1,140 @@
+//******************************************************************************
+//* File:   RectMorphology.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "RectMorphology.h"
+
+namespace oat {
+
+struct MinOp {
+    uint8_t operator()(const uint8_t a, const uint8_t b) const {
+        return a < b ? a : b;
+    }
+};
+
+struct MaxOp {
+    uint8_t operator()(const uint8_t a, const uint8_t b) const {
+        return a > b ? a : b;
+    }
+};
+
+void RectMorphology::erode(cv::Mat &frame, const int size) {
+
+    // Pixels outside the frame do not take part (border value is maximal)
+    apply(frame, size, 255, MinOp());
+}
+
+void RectMorphology::dilate(cv::Mat &frame, const int size) {
+
+    // Pixels outside the frame do not take part (border value is minimal)
+    apply(frame, size, 0, MaxOp());
+}
+
+template <typename Op>
+void RectMorphology::apply(cv::Mat &frame,
+                           const int size,
+                           const uint8_t identity,
+                           Op op) {
+
+    if (frame.type() != CV_8UC1)
+        throw std::runtime_error("Morphology requires 8-bit single channel frames.");
+
+    if (size <= 1 || frame.empty())
+        return;
+
+    const int k = size;
+    const int a = k / 2;
+    const int rows = frame.rows, cols = frame.cols;
+
+    // Row pass. The row is padded so that window x is row_ext_[x, x + k).
+    {
+        const int m = cols + k - 1;
+        row_ext_.assign(m, identity);
+        row_g_.resize(m);
+        row_h_.resize(m);
+
+        for (int y = 0; y < rows; y++) {
+
+            uint8_t *p = frame.ptr<uint8_t>(y);
+            std::copy(p, p + cols, row_ext_.begin() + a);
+
+            // Prefix extrema from the start of each block
+            for (int j = 0; j < m; j++)
+                row_g_[j] = j % k == 0 ? row_ext_[j] : op(row_g_[j - 1], row_ext_[j]);
+
+            // Suffix extrema to the end of each block
+            for (int j = m - 1; j >= 0; j--)
+                row_h_[j] = (j == m - 1 || (j + 1) % k == 0) ?
+                            row_ext_[j] : op(row_h_[j + 1], row_ext_[j]);
+
+            for (int x = 0; x < cols; x++)
+                p[x] = op(row_h_[x], row_g_[x + k - 1]);
+        }
+    }
+
+    // Column pass over whole rows. Padded row j is frame row j - a.
+    {
+        const int m = rows + k - 1;
+        identity_.assign(cols, identity);
+        col_g_.resize(static_cast<size_t>(m) * cols);
+        col_h_.resize(static_cast<size_t>(m) * cols);
+
+        auto ext = [&](const int j) -> const uint8_t * {
+            const int y = j - a;
+            return y >= 0 && y < rows ? frame.ptr<uint8_t>(y) : identity_.data();
+        };
+
+        for (int j = 0; j < m; j++) {
+            const uint8_t *e = ext(j);
+            uint8_t *g = &col_g_[static_cast<size_t>(j) * cols];
+            if (j % k == 0) {
+                std::memcpy(g, e, cols);
+            } else {
+                const uint8_t *g0 = g - cols;
+                for (int x = 0; x < cols; x++)
+                    g[x] = op(g0[x], e[x]);
+            }
+        }
+
+        for (int j = m - 1; j >= 0; j--) {
+            const uint8_t *e = ext(j);
+            uint8_t *h = &col_h_[static_cast<size_t>(j) * cols];
+            if (j == m - 1 || (j + 1) % k == 0) {
+                std::memcpy(h, e, cols);
+            } else {
+                const uint8_t *h1 = h + cols;
+                for (int x = 0; x < cols; x++)
+                    h[x] = op(h1[x], e[x]);
+            }
+        }
+
+        for (int y = 0; y < rows; y++) {
+            const uint8_t *h = &col_h_[static_cast<size_t>(y) * cols];
+            const uint8_t *g = &col_g_[static_cast<size_t>(y + k - 1) * cols];
+            uint8_t *p = frame.ptr<uint8_t>(y);
+            for (int x = 0; x < cols; x++)
+                p[x] = op(h[x], g[x]);
+        }
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,67 @@
+//******************************************************************************
+//* File:   RectMorphology.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#ifndef OAT_RECTMORPHOLOGY_H
+#define	OAT_RECTMORPHOLOGY_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Erosion and dilation of 8-bit frames by a square structuring element,
+ * using the van Herk/Gil-Werman algorithm. Each of the separable row and
+ * column passes takes three min/max operations per pixel, regardless of the
+ * kernel size, by combining running prefix and suffix extrema over blocks of
+ * the kernel size. The column pass works on whole rows at a time so that
+ * the compiler can vectorize it. Results are identical to cv::erode and
+ * cv::dilate with a rectangular element and default anchor and border.
+ * Working buffers are kept between calls.
+ */
+class RectMorphology {
+
+public:
+
+    /**
+     * @brief Erode a frame in place.
+     * @param frame 8-bit, single channel frame.
+     * @param size Kernel side length (pixels).
+     */
+    void erode(cv::Mat &frame, const int size);
+
+    /**
+     * @brief Dilate a frame in place.
+     * @param frame 8-bit, single channel frame.
+     * @param size Kernel side length (pixels).
+     */
+    void dilate(cv::Mat &frame, const int size);
+
+private:
+
+    std::vector<uint8_t> row_ext_, row_g_, row_h_, identity_;
+    std::vector<uint8_t> col_g_, col_h_;
+
+    template <typename Op>
+    void apply(cv::Mat &frame, const int size, const uint8_t identity, Op op);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_RECTMORPHOLOGY_H */
@@ -22,6 +22,8 @@
 #include <csignal>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +36,9 @@
 #include "PositionDetector.h"
 #include "HSVDetector.h"
 #include "DifferenceDetector.h"
+#include "CamShiftDetector.h"
+#include "BrightSpotDetector.h"
+#include "MultiHSVDetector.h"
 
 namespace po = boost::program_options;
 
@@ -47,7 +52,11 @@ void printUsage(po::options_description options) {
               << "Publish detected object positions to SINK.\n\n"
               << "TYPE\n"
               << "  diff: Difference detector (grey-scale, motion)\n"
-              << "  hsv : HSV detector (color)\n\n"
+              << "  hsv : HSV detector (color)\n"
+              << "  camshift: HSV detector followed by CamShift tracking (color)\n"
+              << "  spot: Bright spot detector (e.g. IR LEDs)\n"
+              << "  multihsv: HSV detector for several targets, each published\n"
+              << "            to SINK_TARGET (color)\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive frames "
               << "from (e.g. raw).\n\n"
@@ -82,6 +91,42 @@ void run(const std::shared_ptr<oat::PositionDetector>& detector) {
     }
 }
 
+// Detector factory. Returns nullptr for unknown types.
+std::shared_ptr<oat::PositionDetector> makeDetector(const char type,
+                                                    const std::string &source,
+                                                    const std::string &sink) {
+    switch (type) {
+        case 'a':
+            return std::make_shared<oat::DifferenceDetector>(source, sink);
+        case 'b':
+            return std::make_shared<oat::HSVDetector>(source, sink);
+        case 'c':
+            return std::make_shared<oat::CamShiftDetector>(source, sink);
+        case 'd':
+            return std::make_shared<oat::BrightSpotDetector>(source, sink);
+        case 'e':
+            return std::make_shared<oat::MultiHSVDetector>(source, sink);
+        default:
+            return nullptr;
+    }
+}
+
+// Parse an arena specified as NAME:X,Y,WIDTH,HEIGHT
+void parseArena(const std::string &arg, std::string &name, cv::Rect &roi) {
+
+    const auto colon = arg.find(':');
+    char c0 = 0, c1 = 0, c2 = 0;
+    std::istringstream ss(colon == std::string::npos ? "" : arg.substr(colon + 1));
+    ss >> roi.x >> c0 >> roi.y >> c1 >> roi.width >> c2 >> roi.height;
+
+    if (colon == 0 || colon == std::string::npos || ss.fail() || !ss.eof()
+        || c0 != ',' || c1 != ',' || c2 != ',')
+        throw (std::runtime_error("Arena '" + arg + "' must be specified as "
+                                  "NAME:X,Y,WIDTH,HEIGHT.\n"));
+
+    name = arg.substr(0, colon);
+}
+
 int main(int argc, char *argv[]) {
 
     std::signal(SIGINT, sigHandler);
@@ -89,6 +134,11 @@ int main(int argc, char *argv[]) {
     std::string source;
     std::string sink;
     std::string type;
+    std::string blob_sink;
+    size_t pipeline_depth = 0;
+    int motion_gate = 0;
+    int max_hold = 0;
+    std::vector<std::string> arenas;
     bool tuning_on = false;
     std::vector<std::string> config_fk;
     bool config_used = false;
@@ -97,6 +147,9 @@ int main(int argc, char *argv[]) {
     std::unordered_map<std::string, char> type_hash;
     type_hash["diff"] = 'a';
     type_hash["hsv"] = 'b';
+    type_hash["camshift"] = 'c';
+    type_hash["spot"] = 'd';
+    type_hash["multihsv"] = 'e';
 
     try {
 
@@ -108,9 +161,35 @@ int main(int argc, char *argv[]) {
 
         po::options_description config("CONFIGURATION");
         config.add_options()
-                ("tune", "Use GUI to tune detection parameters at the cost of performance.")
+                ("tune", "Use GUI to tune detection parameters. The GUI runs on its own "
+                         "thread and is redrawn at most 30 times per second.")
                 ("config,c", po::value<std::vector<std::string> >()->multitoken(),
                 "Configuration file/key pair.")
+                ("blobs,b", po::value<std::string>(&blob_sink),
+                "Also publish the largest object candidates found in each "
+                "frame, up to max_blobs, to this SINK. Each candidate has a "
+                "centroid, area and bounding box. multihsv publishes each "
+                "target's candidates to SINK_TARGET.")
+                ("pipeline,p", po::value<size_t>(&pipeline_depth),
+                "Acquire frames on a separate thread into a ring of this many "
+                "frames, so that frame intake overlaps detection. 0 (default) "
+                "acquires and detects serially.")
+                ("motion-gate,m", po::value<int>(&motion_gate),
+                "Skip detection on frames in which no 8x8 block of the "
+                "grayscale frame changed by more than this intensity (0-255) "
+                "since the last detected frame. The previous position is "
+                "published again with the new sample number and flagged as "
+                "held. 0 (default) detects on every frame.")
+                ("max-hold", po::value<int>(&max_hold),
+                "With --motion-gate, detect at least once every this many "
+                "frames. 0 (default) for no limit.")
+                ("arena,a", po::value<std::vector<std::string> >(&arenas)->composing(),
+                "Arena, NAME:X,Y,WIDTH,HEIGHT, of the frame to detect within. "
+                "May be given several times. Each arena is searched "
+                "separately, in parallel, and its positions are published to "
+                "SINK_NAME (and blobs to BLOBS_NAME) in full frame "
+                "coordinates. Frames are acquired from SOURCE once for all "
+                "arenas. Arenas must not overlap.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -118,7 +197,10 @@ int main(int argc, char *argv[]) {
                 ("type,t", po::value<std::string>(&type), "Detector type.\n\n"
                 "Values:\n"
                 "  diff: Difference detector (motion).\n"
-                "  hsv: HSV detector (color).")
+                "  hsv: HSV detector (color).\n"
+                "  camshift: HSV detector followed by CamShift tracking (color).\n"
+                "  spot: Bright spot detector (e.g. IR LEDs).\n"
+                "  multihsv: HSV detector for several targets (color).")
                 ("source", po::value<std::string>(&source),
                 "The name of the SOURCE that supplies images on which hsv-filter object detection will be performed."
                 "The server must be of type SMServer<SharedCVMatHeader>\n")
@@ -208,23 +290,11 @@ int main(int argc, char *argv[]) {
     std::shared_ptr<oat::PositionDetector> detector;
 
     // Refine component type
-    switch (type_hash[type]) {
-        case 'a':
-        {
-            detector = std::make_shared<oat::DifferenceDetector>(source, sink);
-            break;
-        }
-        case 'b':
-        {
-            detector = std::make_shared<oat::HSVDetector>(source, sink);
-            break;
-        }
-        default:
-        {
-            printUsage(visible_options);
-            std::cerr << oat::Error("Invalid TYPE specified.\n");
-            return -1;
-        }
+    detector = makeDetector(type_hash[type], source, sink);
+    if (!detector) {
+        printUsage(visible_options);
+        std::cerr << oat::Error("Invalid TYPE specified.\n");
+        return -1;
     }
 
     // The business
@@ -235,12 +305,58 @@ int main(int argc, char *argv[]) {
 
         detector->tuning_on(tuning_on);
 
+        if (!blob_sink.empty())
+            detector->set_blob_sink(blob_sink);
+
+        detector->set_pipeline_depth(pipeline_depth);
+        detector->set_motion_gate(motion_gate, max_hold);
+
+        if (!arenas.empty() && tuning_on)
+            throw (std::runtime_error("Tuning is not available with arenas.\n"));
+
+        // One detector per arena, sharing this detector's frames
+        for (const auto &a : arenas) {
+
+            std::string name;
+            cv::Rect roi;
+            parseArena(a, name, roi);
+
+            auto arena = makeDetector(type_hash[type], source, sink + "_" + name);
+
+            if (config_used)
+                arena->configure(config_fk[0], config_fk[1]);
+
+            arena->tuning_on(false);
+
+            if (!blob_sink.empty())
+                arena->set_blob_sink(blob_sink + "_" + name);
+
+            arena->set_motion_gate(motion_gate, max_hold);
+            detector->add_arena(arena, roi);
+        }
+
         // Tell user
         std::cout << oat::whoMessage(detector->name(),
-                "Listening to source " + oat::sourceText(source) + ".\n")
-                << oat::whoMessage(detector->name(),
-                "Steaming to sink " + oat::sinkText(sink) + ".\n")
-                << oat::whoMessage(detector->name(),
+                "Listening to source " + oat::sourceText(source) + ".\n");
+
+        std::vector<std::string> suffixes {""};
+        if (!arenas.empty()) {
+            suffixes.clear();
+            for (const auto &a : arenas)
+                suffixes.push_back("_" + a.substr(0, a.find(':')));
+        }
+
+        for (const auto &s : suffixes) {
+
+            std::cout << oat::whoMessage(detector->name(),
+                "Steaming to sink " + oat::sinkText(sink + s) + ".\n");
+
+            if (!blob_sink.empty())
+                std::cout << oat::whoMessage(detector->name(),
+                    "Steaming blobs to sink " + oat::sinkText(blob_sink + s) + ".\n");
+        }
+
+        std::cout << oat::whoMessage(detector->name(),
                 "Press CTRL+C to exit.\n");
 
         // Infinite loop until ctrl-c or end of stream signal
@@ -33,8 +33,7 @@ KalmanFilter2D::KalmanFilter2D(const std::string& position_source_address,
   PositionFilter(position_source_address, position_sink_address)
 , tuning_image_title_(position_sink_address + "_tuning")
 {
-    sig_accel_tune_ = static_cast<int>(sig_measure_noise_);
-    sig_measure_noise_tune_ = static_cast<int>(sig_measure_noise_);
+    // Nothing
 }
 
 void KalmanFilter2D::configure(const std::string &config_file,
@@ -76,13 +75,7 @@ void KalmanFilter2D::configure(const std::string &config_file,
         oat::config::getValue(this_config, "sigma_noise", sig_measure_noise_, 0.0);
 
         // GUI for tuning
-        bool config_tune {false};
-        oat::config::getValue(this_config, "tune", config_tune);
-
-        if (config_tune) {
-            tuning_on_ = true;
-            createTuningWindows();
-        }
+        oat::config::getValue(this_config, "tune", tuning_on_);
 
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
@@ -209,57 +202,27 @@ void KalmanFilter2D::initializeStaticMatracies() {
 
 void KalmanFilter2D::tune() {
 
-    // TODO: The display output of this tuning feature is pretty useless. The constant
-    // rescaling makes it very difficult to get a sense of the absolute accuracy of
-    // filtering and how parameters affect this over time.
-    if (tuning_on_) {
+    if (!tuning_on_)
+        return;
 
-        if (!tuning_windows_created_) {
-            createTuningWindows();
-        }
+    if (!tuner_)
+        createTuningWindows();
 
-        // Use the new parameters to create new static filter matracies
-        sig_accel_ = static_cast<double>(sig_accel_tune_);
-        sig_measure_noise_ = static_cast<double>(sig_measure_noise_tune_);
+    // Static filter matracies are only rebuilt when a slider has moved
+    if (tuner_->update()) {
+        sig_accel_ = static_cast<double>(tuner_->value(0));
+        sig_measure_noise_ = static_cast<double>(tuner_->value(1));
         initializeStaticMatracies();
-
-        //cv::Mat tuning_canvas(canvas_hw, canvas_hw, CV_8UC3);
-        //tuning_canvas.setTo(255);
-        //drawPosition(tuning_canvas, raw_position);
-        //drawPosition(tuning_canvas, filtered_position);
-
-        // Draw the result, update sliders
-        //cv::imshow(tuning_image_title_, tuning_canvas);
-
-        // If user hits escape, close the tuning windows
-        char user_input;
-        user_input = cv::waitKey(1);
-        if (user_input == 27) { // Capture 'ESC' key
-            tuning_on_ = false;
-        }
-
-    } else if (!tuning_on_ && tuning_windows_created_) {
-        // Destroy the tuning windows
-
-        // TODO: Window will not actually close!!
-        cv::destroyWindow(tuning_image_title_);
-        tuning_windows_created_ = false;
-
     }
 }
 
 void KalmanFilter2D::createTuningWindows() {
 
-    // Create window for sliders
-    cv::namedWindow(tuning_image_title_, cv::WINDOW_AUTOSIZE);
-
-    // Create sliders and insert them into window
-    sig_accel_tune_ = static_cast<int>(sig_accel_);
-    sig_measure_noise_tune_ = static_cast<int>(sig_measure_noise_);
-    cv::createTrackbar("SIGMA ACCEL.", tuning_image_title_, &sig_accel_tune_, 1000);
-    cv::createTrackbar("SIGMA NOISE", tuning_image_title_, &sig_measure_noise_tune_, 10);
-
-    tuning_windows_created_ = true;
+    // Sliders only. The window runs on its own thread and closes on ESC.
+    tuner_.reset(new oat::TuningWindow(tuning_image_title_));
+    tuner_->addSlider("SIGMA ACCEL.", static_cast<int>(sig_accel_), 1000);
+    tuner_->addSlider("SIGMA NOISE", static_cast<int>(sig_measure_noise_), 10);
+    tuner_->start();
 }
 
 //void KalmanFilter2D::drawPosition(cv::Mat& canvas, const datatypes::Position2D& position) {
@@ -20,9 +20,12 @@
 #ifndef OAT_KALMANFILTER2D_H
 #define	OAT_KALMANFILTER2D_H
 
+#include <memory>
 #include <string>
 #include <opencv2/opencv.hpp>
 
+#include "../../lib/utility/TuningWindow.h"
+
 #include "PositionFilter.h"
 
 namespace oat {
@@ -66,9 +69,7 @@ private:
 
     // Parameter tuning
     std::string tuning_image_title_;
-    bool tuning_windows_created_ {false};
-    int sig_accel_tune_;
-    int sig_measure_noise_tune_;
+    std::unique_ptr<oat::TuningWindow> tuner_;
     bool tuning_on_ {false};
     float draw_scale_ {10.0};
 
@@ -0,0 +1,87 @@
+//******************************************************************************
+//* File:   BinaryPositionWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+#include "BinaryPositionWriter.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "../../lib/utility/FileFormat.h"
+
+namespace oat {
+
+BinaryPositionWriter::BinaryPositionWriter(const std::string &path,
+                                           const uint32_t columns) :
+  Writer<oat::Position2D>(path)
+, columns_(columns & oat::poslog::ALL)
+, record_buffer_(oat::poslog::recordBytes(columns_))
+{
+    // Nothing
+}
+
+void BinaryPositionWriter::initialize(const std::string &source_name,
+                                      const oat::Position2D &p) {
+
+    // Position file
+    file_.reset(new oat::AsyncFile(path_));
+
+    std::string version = std::string(Oat_VERSION_MAJOR) + "." + Oat_VERSION_MINOR;
+
+    oat::poslog::Header header;
+    oat::poslog::initializeHeader(header,
+                                  source_name,
+                                  p.sample().rate_hz(),
+                                  columns_,
+                                  version,
+                                  oat::createTimeStamp(true));
+
+    file_->append(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void BinaryPositionWriter::write(const oat::Position2D &p) {
+
+    // File must be avaiable for writing
+    assert(file_);
+
+    oat::poslog::Record r;
+    r.tick = p.sample().count();
+    r.usec = p.sample().microseconds().count();
+    r.unit = static_cast<int32_t>(p.unit_of_length());
+
+    r.flags = 0;
+    if (p.position_valid) r.flags |= oat::poslog::POSITION_VALID;
+    if (p.velocity_valid) r.flags |= oat::poslog::VELOCITY_VALID;
+    if (p.heading_valid) r.flags |= oat::poslog::HEADING_VALID;
+    if (p.region_valid) r.flags |= oat::poslog::REGION_VALID;
+    if (p.position_held) r.flags |= oat::poslog::POSITION_HELD;
+
+    r.position[0] = p.position.x;
+    r.position[1] = p.position.y;
+    r.velocity[0] = p.velocity.x;
+    r.velocity[1] = p.velocity.y;
+    r.heading[0] = p.heading.x;
+    r.heading[1] = p.heading.y;
+    strncpy(r.region, p.region, sizeof(r.region) - 1);
+
+    oat::poslog::packRecord(r, columns_, record_buffer_.data());
+    file_->append(record_buffer_.data(), record_buffer_.size());
+}
+
+} /* namespace oat */
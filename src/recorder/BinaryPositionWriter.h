@@ -0,0 +1,69 @@
+//******************************************************************************
+//* File:   BinaryPositionWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_BINARYPOSITIONWRITER_H
+#define OAT_BINARYPOSITIONWRITER_H
+
+#include "Writer.h"
+
+#include <memory>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/AsyncFile.h"
+#include "../../lib/utility/PositionLog.h"
+
+namespace oat {
+
+/**
+ * Position stream binary file writer. Writes the fixed record format defined
+ * in oat::poslog. Records are written in the background by an
+ * oat::AsyncFile.
+ */
+class BinaryPositionWriter : public Writer<oat::Position2D> {
+
+public:
+
+    /**
+     * @brief Position stream binary file writer.
+     * @param path Fully qualified file path.
+     * @param columns Bitmask of oat::poslog::Column values to record.
+     */
+    BinaryPositionWriter(const std::string &path,
+                         const uint32_t columns = oat::poslog::ALL);
+
+    void initialize(const std::string &source_name,
+                    const oat::Position2D &p) override;
+
+    void write(const oat::Position2D &p) override;
+
+private:
+
+    // Record columns written to file
+    const uint32_t columns_;
+
+    // Position file
+    std::unique_ptr<oat::AsyncFile> file_;
+
+    // Single packed record, reused for each sample
+    std::vector<char> record_buffer_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_BINARYPOSITIONWRITER_H */
@@ -0,0 +1,110 @@
+//******************************************************************************
+//* File:   FrameTransform.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#include "FrameTransform.h"
+
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
+
+namespace oat {
+
+FrameTransform::FrameTransform(const cv::Rect &crop,
+                               const int decimation,
+                               const bool grayscale) :
+  crop_(crop)
+, decimation_(decimation)
+, grayscale_(grayscale)
+{
+    if (decimation_ < 1)
+        throw std::runtime_error("Frame decimation must be a positive integer.");
+}
+
+cv::Size FrameTransform::outputSize(const cv::Size &size) const {
+
+    cv::Size s = size;
+
+    if (crop_.area() > 0) {
+        if ((crop_ & cv::Rect(cv::Point(0, 0), size)) != crop_)
+            throw std::runtime_error("Recording crop region is outside of "
+                                     "the frame.");
+        s = crop_.size();
+    }
+
+    s.width /= decimation_;
+    s.height /= decimation_;
+
+    if (s.area() == 0)
+        throw std::runtime_error("Recording decimation leaves an empty frame.");
+
+    return s;
+}
+
+bool FrameTransform::outputColor(const int channels) const {
+
+    return channels > 1 && !grayscale_;
+}
+
+const cv::Mat & FrameTransform::operator()(const cv::Mat &frame) {
+
+    // Cropping only creates a header into the input frame
+    cropped_ = crop_.area() > 0 ? frame(crop_) : frame;
+    const cv::Mat *out = &cropped_;
+
+    // Decimating before color conversion means fewer pixels to convert.
+    // INTER_AREA averages each block for integer scale factors.
+    if (decimation_ > 1) {
+        cv::resize(*out,
+                   decimated_,
+                   cv::Size(out->cols / decimation_, out->rows / decimation_),
+                   0, 0,
+                   cv::INTER_AREA);
+        out = &decimated_;
+    }
+
+    if (grayscale_ && out->channels() == 3) {
+        cv::cvtColor(*out, gray_, cv::COLOR_BGR2GRAY);
+        out = &gray_;
+    }
+
+    return *out;
+}
+
+bool FrameTransform::identity() const {
+
+    return crop_.area() == 0 && decimation_ == 1 && !grayscale_;
+}
+
+std::string FrameTransform::describe() const {
+
+    std::string d;
+    auto append = [&d](const std::string &s) {
+        d += d.empty() ? s : "_" + s;
+    };
+
+    if (crop_.area() > 0)
+        append("crop");
+    if (decimation_ > 1)
+        append("dec" + std::to_string(decimation_));
+    if (grayscale_)
+        append("gray");
+
+    return d;
+}
+
+} /* namespace oat */
@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   FrameTransform.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_FRAMETRANSFORM_H
+#define OAT_FRAMETRANSFORM_H
+
+#include <string>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+/**
+ * Transform applied to frames before they are encoded: crop, then integer
+ * decimation, then conversion to grayscale. Output buffers are reused
+ * between frames.
+ */
+class FrameTransform {
+
+public:
+
+    FrameTransform() = default;
+
+    /**
+     * @brief Frame transform.
+     * @param crop Region of the frame to keep. Empty to keep the whole frame.
+     * @param decimation Keep one pixel in every decimation x decimation
+     * block, by averaging.
+     * @param grayscale Convert color frames to grayscale.
+     */
+    FrameTransform(const cv::Rect &crop,
+                   const int decimation,
+                   const bool grayscale);
+
+    /**
+     * @brief Check that the transform can be applied to frames of a given
+     * size.
+     * @param size Input frame size.
+     * @return Output frame size.
+     */
+    cv::Size outputSize(const cv::Size &size) const;
+
+    /**
+     * @brief True if output frames have more than one channel.
+     * @param channels Number of channels in input frames.
+     */
+    bool outputColor(const int channels) const;
+
+    /**
+     * @brief Apply the transform.
+     * @param frame Input frame.
+     * @return Transformed frame. Valid until the next call.
+     */
+    const cv::Mat & operator()(const cv::Mat &frame);
+
+    /**
+     * @brief True if frames are passed through unmodified.
+     */
+    bool identity(void) const;
+
+    /**
+     * @brief Short description of the transform, e.g. 'crop_dec4_gray',
+     * for use in file names. Empty for the identity transform.
+     */
+    std::string describe(void) const;
+
+private:
+
+    cv::Rect crop_;
+    int decimation_ {1};
+    bool grayscale_ {false};
+
+    cv::Mat cropped_, decimated_, gray_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_FRAMETRANSFORM_H */
@@ -17,31 +17,152 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //*****************************************************************************
 
+#include "OatConfig.h" // Generated by CMake
 #include "FrameWriter.h"
 
 #include <iostream>
 #include <cassert>
+#include <boost/filesystem.hpp>
+
+#include "../../lib/utility/FileFormat.h"
+#include "../../lib/utility/FrameIndex.h"
 
 namespace oat {
 
+FrameWriter::FrameWriter(const std::vector<std::string> &paths,
+                         const std::vector<oat::FrameTransform> &transforms) :
+  Writer<oat::Frame>(paths.at(0))
+{
+    assert(paths.size() == transforms.size());
+
+    for (size_t i = 0; i < paths.size(); i++) {
+
+        if (!oat::checkWritePermission(paths[i]))
+            throw (std::runtime_error("Write permission denied for " + paths[i]));
+
+        Stream s;
+        s.path = paths[i];
+        s.transform = transforms[i];
+        streams_.push_back(std::move(s));
+    }
+}
+
+FrameWriter::~FrameWriter() {
+
+    if (in_gap_)
+        closeGap();
+
+    for (auto &s : streams_)
+        if (s.gap_fd != nullptr)
+            fclose(s.gap_fd);
+}
+
 void FrameWriter::initialize(const std::string &source_name,
                              const oat::Frame &f) {
 
     // Initialize writer using the first frame taken from server
     int fourcc = cv::VideoWriter::fourcc('H', '2', '6', '4');
-    video_writer_.open(path_, fourcc, f.sample().rate_hz(), f.size());
+
+    // cv::VideoWriter does not report where it puts encoded frames, so only
+    // sample numbers and times are indexed
+    oat::frameidx::Header header;
+    oat::frameidx::initializeHeader(header,
+                                    source_name,
+                                    f.sample().rate_hz(),
+                                    0,
+                                    std::string(Oat_VERSION_MAJOR) + "." + Oat_VERSION_MINOR,
+                                    oat::createTimeStamp(true));
+
+    for (auto &s : streams_) {
+
+        s.video_writer.open(s.path,
+                            fourcc,
+                            f.sample().rate_hz(),
+                            s.transform.outputSize(f.size()),
+                            s.transform.outputColor(f.channels()));
+
+        auto path = boost::filesystem::path(s.path)
+                        .replace_extension(".idx").string();
+        s.index.reset(new oat::AsyncFile(path, FRAME_INDEX_BLOCK_BYTES));
+        s.index->append(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
 }
 
-void FrameWriter::write(void) {
+void FrameWriter::write(const oat::Frame &f) {
+
+    if (in_gap_)
+        closeGap();
+
+    oat::frameidx::Record r;
+    r.tick = f.sample().count();
+    r.usec = f.sample().microseconds().count();
+    r.frame = frames_written_;
 
-    cv::Mat mat;
-    while (buffer_.pop(mat)) {
+    for (auto &s : streams_) {
 
         // File desriptor must be avaiable for writing
-        assert(video_writer_.isOpened());
+        assert(s.video_writer.isOpened());
 
-        video_writer_.write(mat);
+        if (s.transform.identity())
+            s.video_writer.write(f);
+        else
+            s.video_writer.write(s.transform(f));
+
+        s.index->append(reinterpret_cast<const char *>(&r), sizeof(r));
     }
+
+    frames_written_++;
+}
+
+void FrameWriter::skip(const oat::Frame &f) {
+
+    for (auto &s : streams_) {
+
+        if (s.gap_fd != nullptr)
+            continue;
+
+        auto path = boost::filesystem::path(s.path)
+                        .replace_extension(".gaps.csv").string();
+        s.gap_fd = fopen(path.c_str(), "w");
+        if (s.gap_fd == nullptr)
+            throw (std::runtime_error("Could not open " + path + " for writing."));
+
+        fprintf(s.gap_fd, "video_frame,first_tick,last_tick,first_usec,last_usec\n");
+    }
+
+    if (!in_gap_) {
+        in_gap_ = true;
+        gap_first_sample_ = f.sample().count();
+        gap_first_usec_ = f.sample().microseconds().count();
+    }
+
+    gap_last_sample_ = f.sample().count();
+    gap_last_usec_ = f.sample().microseconds().count();
+}
+
+std::vector<std::string> FrameWriter::files() const {
+
+    std::vector<std::string> f;
+    for (auto &s : streams_)
+        f.push_back(s.path);
+
+    return f;
+}
+
+void FrameWriter::closeGap() {
+
+    // The gap precedes video frame frames_written_ of every stream
+    for (auto &s : streams_) {
+        fprintf(s.gap_fd, "%llu,%llu,%llu,%lld,%lld\n",
+                static_cast<unsigned long long>(frames_written_),
+                static_cast<unsigned long long>(gap_first_sample_),
+                static_cast<unsigned long long>(gap_last_sample_),
+                static_cast<long long>(gap_first_usec_),
+                static_cast<long long>(gap_last_usec_));
+        fflush(s.gap_fd);
+    }
+
+    in_gap_ = false;
 }
 
 } /* namespace oat */
@@ -20,38 +20,84 @@
 #ifndef OAT_FRAMEWRITER_H
 #define OAT_FRAMEWRITER_H
 
+#include "FrameTransform.h"
 #include "Writer.h"
 
+#include <cstdio>
+#include <memory>
+#include <vector>
 #include <opencv2/videoio.hpp>
 
 #include "../../lib/datatypes/Frame.h"
+#include "../../lib/utility/AsyncFile.h"
 
 namespace oat {
-namespace blf = boost::lockfree;
 
 // Constants
 static constexpr int FRAME_WRITE_BUFFER_SIZE {1000};
+static constexpr size_t FRAME_INDEX_BLOCK_BYTES {1 << 16};
 
 /**
- * Frame stream video file writer.
+ * Video recorded from a frame SOURCE.
  */
-class FrameWriter : public Writer<oat::Frame> {
+struct FrameStream {
+    std::string name;               //!< Appended to the SOURCE name in file names
+    oat::FrameTransform transform;  //!< Applied to frames before encoding
+};
 
-    // Inherit constructor
-    using Writer<oat::Frame>::Writer;
+/**
+ * Frame stream video file writer. Frames from a single SOURCE are encoded to
+ * one video file per stream, each with its own transform. Transforms are
+ * applied by the thread calling write. The sample number and time of each
+ * encoded frame are written to a .idx file next to each video.
+ */
+class FrameWriter : public Writer<oat::Frame> {
 
 public:
 
-    ~FrameWriter() { };
+    /**
+     * @brief Frame stream video file writer.
+     * @param paths Video file path of each stream.
+     * @param transforms Transform of each stream.
+     */
+    FrameWriter(const std::vector<std::string> &paths,
+                const std::vector<oat::FrameTransform> &transforms);
+
+    ~FrameWriter();
 
     void initialize(const std::string &source_name,
                     const oat::Frame &f) override;
 
-    void write(void) override;
+    void write(const oat::Frame &f) override;
+
+    /**
+     * @brief Record a frame that was skipped by the record gate. Runs of
+     * skipped frames are written to a .gaps.csv file next to each video.
+     */
+    void skip(const oat::Frame &f) override;
+
+    std::vector<std::string> files(void) const override;
     
 private:
 
-    cv::VideoWriter video_writer_; 
+    struct Stream {
+        std::string path;
+        oat::FrameTransform transform;
+        cv::VideoWriter video_writer;
+        std::unique_ptr<oat::AsyncFile> index; // Frame index (see oat::frameidx)
+        FILE * gap_fd {nullptr}; // Gap index, created on the first skipped frame
+    };
+
+    std::vector<Stream> streams_;
+
+    // Number of frames written to each video
+    uint64_t frames_written_ {0};
+
+    // Current run of skipped frames
+    bool in_gap_ {false};
+    uint64_t gap_first_sample_ {0}, gap_last_sample_ {0};
+    int64_t gap_first_usec_ {0}, gap_last_usec_ {0};
+    void closeGap(void);
 
 };
 }      /* namespace oat */
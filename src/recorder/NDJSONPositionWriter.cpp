@@ -0,0 +1,126 @@
+//******************************************************************************
+//* File:   NDJSONPositionWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+#include "NDJSONPositionWriter.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "../../lib/utility/FileFormat.h"
+
+namespace oat {
+
+void NDJSONPositionWriter::initialize(const std::string &source_name,
+                                      const oat::Position2D &p) {
+
+    // Position file. A single I/O thread makes the file grow in order for
+    // readers tailing it.
+    file_.reset(new oat::AsyncFile(path_,
+                                   oat::ASYNC_FILE_BLOCK_BYTES,
+                                   oat::ASYNC_FILE_BLOCKS,
+                                   1));
+    line_.Clear();
+    json_writer_.Reset(line_);
+
+    // Header line
+    json_writer_.StartObject();
+
+    std::string version = std::string(Oat_VERSION_MAJOR) + "." + Oat_VERSION_MINOR;
+    json_writer_.String("oat_version");
+    json_writer_.String(version.c_str());
+
+    json_writer_.String("header");
+
+    json_writer_.StartObject();
+    json_writer_.String("date");
+    json_writer_.String(oat::createTimeStamp(true).c_str());
+
+    auto fs = p.sample().rate_hz();
+    json_writer_.String("sample_rate_hz");
+    if (std::isfinite(fs))
+        json_writer_.Double(fs);
+    else
+        json_writer_.Double(-1.0);
+
+    json_writer_.String("source");
+    json_writer_.String(source_name.c_str());
+    json_writer_.EndObject();
+
+    json_writer_.EndObject();
+    endLine();
+
+    // Make the header visible to readers straight away
+    file_->flush();
+    unflushed_ = false;
+}
+
+void NDJSONPositionWriter::write(const oat::Position2D &p) {
+
+    // File must be avaiable for writing
+    assert(file_);
+
+    json_writer_.StartObject();
+    p.Serialize(json_writer_, verbose_file_);
+    json_writer_.EndObject();
+    endLine();
+}
+
+void NDJSONPositionWriter::poll() {
+
+    if (file_)
+        flushIfDue(std::chrono::steady_clock::now());
+}
+
+void NDJSONPositionWriter::endLine() {
+
+    line_.Put('\n');
+
+    // Lines are appended whole. If the current block cannot hold the line,
+    // it is submitted first so that every write ends on a complete line.
+    if (file_->available() < line_.GetSize())
+        file_->flush();
+
+    file_->append(line_.GetString(), line_.GetSize());
+
+    // Each line is a complete JSON document. The buffer keeps its capacity.
+    line_.Clear();
+    json_writer_.Reset(line_);
+
+    auto now = std::chrono::steady_clock::now();
+    if (!unflushed_) {
+        unflushed_ = true;
+        oldest_unflushed_ = now;
+    }
+
+    flushIfDue(now);
+}
+
+void NDJSONPositionWriter::flushIfDue(const std::chrono::steady_clock::time_point now) {
+
+    // Partially filled blocks are written periodically so that readers
+    // tailing the file do not fall far behind
+    if (unflushed_ &&
+        now - oldest_unflushed_ >= std::chrono::milliseconds(NDJSON_FLUSH_PERIOD_MS)) {
+        file_->flush();
+        unflushed_ = false;
+    }
+}
+
+} /* namespace oat */
@@ -0,0 +1,87 @@
+//******************************************************************************
+//* File:   NDJSONPositionWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_NDJSONPOSITIONWRITER_H
+#define OAT_NDJSONPOSITIONWRITER_H
+
+#include "Writer.h"
+
+#include <chrono>
+#include <memory>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/AsyncFile.h"
+
+namespace oat {
+
+// Constants
+static constexpr int NDJSON_FLUSH_PERIOD_MS {100};
+
+/**
+ * Position stream line-delimited JSON file writer. The first line holds the
+ * file header and each following line holds a single position, so that a
+ * partially written file remains readable and a file can be tailed while it
+ * is being recorded. Each line is serialized into a reusable buffer and then
+ * copied into the preallocated blocks of an oat::AsyncFile. A block is
+ * submitted before a line that does not fit in it, so lines are never split
+ * between writes, and once it holds a line that is older than
+ * NDJSON_FLUSH_PERIOD_MS, even if no further positions arrive.
+ */
+class NDJSONPositionWriter : public Writer<oat::Position2D> {
+
+    // Inherit constructor
+    using Writer<oat::Position2D>::Writer;
+
+public:
+
+    void initialize(const std::string &source_name,
+                    const oat::Position2D &p) override;
+
+    void write(const oat::Position2D &p) override;
+
+    void poll(void) override;
+
+    // Accessors
+    void set_verbose_file(const bool value) { verbose_file_ = value; }
+
+private:
+
+    // See oat::PositionWriter
+    bool verbose_file_ {true};
+
+    // Position file
+    std::unique_ptr<oat::AsyncFile> file_;
+    rapidjson::StringBuffer line_;
+    rapidjson::Writer<rapidjson::StringBuffer> json_writer_;
+
+    // Time at which the oldest line that has not been flushed was appended
+    bool unflushed_ {false};
+    std::chrono::steady_clock::time_point oldest_unflushed_;
+
+    // Terminate the current line and append it to the file
+    void endLine(void);
+
+    // Flush lines that are older than NDJSON_FLUSH_PERIOD_MS
+    void flushIfDue(const std::chrono::steady_clock::time_point now);
+};
+
+}      /* namespace oat */
+#endif /* OAT_NDJSONPOSITIONWRITER_H */
@@ -28,21 +28,20 @@ namespace oat {
 
 PositionWriter::~PositionWriter() 
 {
+    if (!file_)
+        return;
+
+    // The file writes everything that was appended when it is destroyed
     json_writer_.EndArray();
     json_writer_.EndObject();
-    file_stream_->Flush();
 }
 
 void PositionWriter::initialize(const std::string &source_name,
                                 const oat::Position2D &p) {
 
     // Position file 
-    fd_ = fopen(path_.c_str(), "wb");
-
-    file_stream_.reset(new rapidjson::FileWriteStream(
-            fd_,
-            position_write_buffer, 
-            sizeof(position_write_buffer)));
+    file_.reset(new oat::AsyncFile(path_));
+    file_stream_.reset(new oat::AsyncFileStream(*file_));
     json_writer_.Reset(*file_stream_);
 
     // Main object, end this object before write flush in destructor
@@ -81,20 +80,16 @@ void PositionWriter::initialize(const std::string &source_name,
     json_writer_.StartArray();
 }
 
-void PositionWriter::write(void) {
-
-    oat::Position2D p("");
-    while (buffer_.pop(p)) {
+void PositionWriter::write(const oat::Position2D &p) {
 
-        // File desriptor must be avaiable for writing
-        assert(fd_);
+    // File must be avaiable for writing
+    assert(file_);
 
-        json_writer_.StartObject();
-        //json_writer_.String("time");
-        //json_writer_.String(oat::createTimeStamp(true).c_str());
-        p.Serialize(json_writer_, verbose_file_);
-        json_writer_.EndObject();
-    }
+    json_writer_.StartObject();
+    //json_writer_.String("time");
+    //json_writer_.String(oat::createTimeStamp(true).c_str());
+    p.Serialize(json_writer_, verbose_file_);
+    json_writer_.EndObject();
 }
     
 } /* namespace oat */
@@ -22,19 +22,17 @@
 
 #include "Writer.h"
 
-#include <rapidjson/filewritestream.h>
+#include <memory>
 #include <rapidjson/prettywriter.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/AsyncFile.h"
 
 namespace oat {
-namespace blf = boost::lockfree;
-
-// Constants
-static constexpr int POSITION_WRITE_BUFFER_SIZE {65536};
 
 /**
- * Position stream file writer.
+ * Position stream file writer. The JSON document is written in the
+ * background by an oat::AsyncFile.
  */
 class PositionWriter : public Writer<oat::Position2D> {
 
@@ -45,7 +43,7 @@ public:
 
     ~PositionWriter();
 
-    void write(void) override;
+    void write(const oat::Position2D &p) override;
 
     void initialize(const std::string &source_name,
                     const oat::Position2D &p) override;
@@ -68,10 +66,9 @@ private:
 
     // Position file
     // TODO: Position specialization
-    FILE * fd_ {nullptr};
-    char position_write_buffer[POSITION_WRITE_BUFFER_SIZE];
-    std::unique_ptr<rapidjson::FileWriteStream> file_stream_;
-    rapidjson::PrettyWriter<rapidjson::FileWriteStream> json_writer_ {*file_stream_};
+    std::unique_ptr<oat::AsyncFile> file_;
+    std::unique_ptr<oat::AsyncFileStream> file_stream_;
+    rapidjson::PrettyWriter<oat::AsyncFileStream> json_writer_;
 };
 
 }      /* namespace oat */
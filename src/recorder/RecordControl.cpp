@@ -38,7 +38,6 @@ namespace oat {
  *
  * @return Code:
  * 0. Normal exit.
- * 1. Create new recorder (with new file name) and re-enter.
  */
 int controlRecorder(std::istream &in,
                     std::ostream &out,
@@ -53,6 +52,7 @@ int controlRecorder(std::istream &in,
     cmd_map["pause"] = 'p';
     cmd_map["new"] = 'n';
     cmd_map["ping"] = 'i';
+    cmd_map["stats"] = 't';
 
     // User control loop
     std::string cmd;
@@ -104,15 +104,21 @@ int controlRecorder(std::istream &in,
             }
             case 'n' :
             {
-                recorder.set_record_on(false);
+                recorder.requestRotation();
                 out << "Creating new file." << std::endl;
-                return 1;
+                break;
             }
             case 'i' :
             {
                 out << "Ping received." << std::endl;
                 break;
             }
+            case 't' :
+            {
+                recorder.printQueueTelemetry(out);
+                out << std::flush;
+                break;
+            }
             default :
             {
                 out << "Invalid command \'" << cmd << "\'" << std::endl;
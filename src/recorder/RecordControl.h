@@ -37,6 +37,10 @@ const char interactive_record_control_usage_string[] =
     "            without creating a new file.\n"
     " new        Start a new file using folder location and file name\n"
     "            options as provided in command line arguements.\n"
+    "            Recording continues without interruption; all streams\n"
+    "            switch to the new files on the same sample.\n"
+    " stats      Print the depth, high-water mark and overflow counts\n"
+    "            of each SOURCE's sample queue.\n"
     " quit       Exit the program.\n";
 
 const char remote_record_control_usage_string[] =
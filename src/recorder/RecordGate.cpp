@@ -0,0 +1,131 @@
+//******************************************************************************
+//* File:   RecordGate.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#include "RecordGate.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+
+namespace oat {
+
+RecordGate::RecordGate(const size_t inputs,
+                       const uint64_t pre_roll,
+                       const uint64_t post_roll) :
+  pre_roll_(pre_roll)
+, post_roll_(post_roll)
+, horizon_(inputs, 0)
+{
+    // Nothing
+}
+
+void RecordGate::update(const size_t input,
+                        const uint64_t count,
+                        const bool active) {
+
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    horizon_[input] = std::max(horizon_[input], count);
+
+    if (!active)
+        return;
+
+    // Interval starting after count
+    auto next = active_.upper_bound(count);
+
+    // Extend the preceding interval if count is inside or adjacent to it
+    if (next != active_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->second + 1 >= count) {
+            prev->second = std::max(prev->second, count);
+            if (next != active_.end() && next->first <= prev->second + 1) {
+                prev->second = std::max(prev->second, next->second);
+                active_.erase(next);
+            }
+            return;
+        }
+    }
+
+    // Otherwise start a new one, merging with the following interval if
+    // adjacent
+    if (next != active_.end() && next->first == count + 1) {
+        uint64_t last = next->second;
+        active_.erase(next);
+        active_[count] = last;
+    } else {
+        active_[count] = count;
+    }
+
+    // Old intervals are only needed by samples that are still queued
+    if (active_.size() > MAX_GATE_INTERVALS)
+        active_.erase(active_.begin());
+}
+
+RecordGate::Decision RecordGate::decide(const uint64_t count) {
+
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    const uint64_t lo = count > post_roll_ ? count - post_roll_ : 0;
+    const uint64_t hi = count + pre_roll_;
+
+    // Last interval starting at or before hi
+    auto it = active_.upper_bound(hi);
+    if (it != active_.begin() && std::prev(it)->second >= lo)
+        return Decision::COMMIT;
+
+    uint64_t known = finished_ ? std::numeric_limits<uint64_t>::max()
+                               : *std::min_element(horizon_.begin(), horizon_.end());
+
+    return known >= hi ? Decision::SKIP : Decision::WAIT;
+}
+
+void RecordGate::finish() {
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    finished_ = true;
+}
+
+double MotionScore::operator()(const cv::Mat &frame) {
+
+    cv::resize(frame,
+               small_,
+               cv::Size(std::max(frame.cols / MOTION_DECIMATION, 1),
+                        std::max(frame.rows / MOTION_DECIMATION, 1)),
+               0, 0,
+               cv::INTER_AREA);
+
+    if (small_.channels() == 3)
+        cv::cvtColor(small_, gray_, cv::COLOR_BGR2GRAY);
+    else
+        small_.copyTo(gray_);
+
+    if (!has_last_) {
+        gray_.copyTo(last_gray_);
+        has_last_ = true;
+        return 0.0;
+    }
+
+    cv::absdiff(gray_, last_gray_, diff_);
+    std::swap(gray_, last_gray_);
+
+    return cv::mean(diff_)[0];
+}
+
+} /* namespace oat */
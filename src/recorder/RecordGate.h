@@ -0,0 +1,122 @@
+//******************************************************************************
+//* File:   RecordGate.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_RECORDGATE_H
+#define OAT_RECORDGATE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace oat {
+
+// Constants
+static constexpr int MOTION_DECIMATION {8};
+static constexpr size_t MAX_GATE_INTERVALS {4096};
+
+/**
+ * Event gate for frame recording. One or more inputs (SOURCEs) report, for
+ * each sample number, whether a gating condition is met. A sample is
+ * committed to file if the condition is met by any input within pre_roll
+ * samples after it or post_roll samples before it.
+ */
+class RecordGate {
+
+public:
+
+    enum class Decision {
+        WAIT = 0,   //!< Not yet known; inputs have not reached the pre-roll
+        COMMIT = 1, //!< Record the sample
+        SKIP = 2    //!< Do not record the sample
+    };
+
+    /**
+     * @brief Event gate.
+     * @param inputs Number of inputs driving the gate.
+     * @param pre_roll Samples recorded before the condition becomes met.
+     * @param post_roll Samples recorded after the condition stops being met.
+     */
+    RecordGate(const size_t inputs,
+               const uint64_t pre_roll,
+               const uint64_t post_roll);
+
+    /**
+     * @brief Report the gating condition of a sample. Each input must report
+     * samples in increasing order.
+     * @param input Input index.
+     * @param count Sample number.
+     * @param active True if the gating condition is met.
+     */
+    void update(const size_t input, const uint64_t count, const bool active);
+
+    /**
+     * @brief Decide if a sample should be recorded.
+     * @param count Sample number.
+     */
+    Decision decide(const uint64_t count);
+
+    /**
+     * @brief Signal that inputs will not report further samples, so that
+     * pending decisions can be made.
+     */
+    void finish(void);
+
+private:
+
+    const uint64_t pre_roll_;
+    const uint64_t post_roll_;
+
+    std::mutex mutex_;
+
+    // Newest sample reported by each input
+    std::vector<uint64_t> horizon_;
+
+    // Disjoint intervals, [first, last], of samples meeting the condition
+    std::map<uint64_t, uint64_t> active_;
+
+    bool finished_ {false};
+};
+
+/**
+ * Cheap per-frame motion score: mean absolute difference between consecutive
+ * frames, area averaged down and converted to grayscale so that sensor noise
+ * does not register as motion. Buffers are reused between frames.
+ */
+class MotionScore {
+
+public:
+
+    /**
+     * @brief Score a frame.
+     * @param frame Frame to score.
+     * @return Mean absolute difference to the previous frame (0-255). Zero
+     * for the first frame.
+     */
+    double operator()(const cv::Mat &frame);
+
+private:
+
+    cv::Mat small_, gray_, last_gray_, diff_;
+    bool has_last_ {false};
+};
+
+}      /* namespace oat */
+#endif /* OAT_RECORDGATE_H */
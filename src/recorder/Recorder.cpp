@@ -29,6 +29,7 @@
 #include <vector>
 
 #include <sys/stat.h>
+#include <boost/interprocess/exceptions.hpp>
 
 #include "../../lib/utility/FileFormat.h"
 #include "../../lib/utility/IOFormat.h"
@@ -48,6 +49,18 @@ namespace oat {
 // modifying the commandline args. Although, event this last point is suspect.
 // Their could be type deduction built into the shared datatypes.
 
+// Longest time an acquisition thread waits on its SOURCE before checking
+// whether it should stop
+static constexpr int ACQUISITION_WAIT_MS {10};
+
+// Longest time a file rotation waits for a SOURCE that is not publishing
+// before that SOURCE's stream is switched to the new file set regardless
+static constexpr int ROTATION_IDLE_MS {1000};
+
+// Uniform access to the sample held by a SOURCE's node
+static const oat::Frame & sharedSample(const oat::Frame &f) { return f; }
+static const oat::Position2D & sharedSample(const oat::Position2D *p) { return *p; }
+
 // TODO: Sources should be generic in this case and maybe in general. e.g.
 // Filter: T -> F(T) -> T, Source: So -> T, Sink: T -> Si
 Recorder::Recorder(const std::vector<std::string> &position_source_addresses,
@@ -109,11 +122,42 @@ Recorder::~Recorder() {
     // look at a video before the recorder destructs because it will be
     // incomplete! Same with the position file.
 
-    // TODO: Join writer thread
-    // Set running to false to trigger thread join
+    // Set running to false to trigger thread joins
     running_ = false;
+    stopAcquisition();
+
+    if (rotation_thread_.joinable())
+        rotation_thread_.join();
+
     writer_condition_variable_.notify_one();
     writer_thread_.join();
+
+    // Samples held back for the pre-roll can now be decided
+    if (record_gate_)
+        record_gate_->finish();
+
+    // Flush anything that was queued after the last pass of the writer thread
+    std::vector<std::unique_ptr<oat::FrameWriter>> retired_frame_writers;
+    std::vector<std::unique_ptr<oat::Writer<oat::Position2D>>>
+        retired_position_writers;
+
+    for (auto &s: frame_writers_)
+        writeSlot(s, retired_frame_writers);
+
+    for (auto &s: position_writers_)
+        writeSlot(s, retired_position_writers);
+
+    // Report lost samples
+    uint64_t dropped = 0;
+    for (auto &s: frame_writers_)
+        if (s.queue) dropped += s.queue->telemetry().dropped;
+    for (auto &s: position_writers_)
+        if (s.queue) dropped += s.queue->telemetry().dropped;
+
+    if (dropped > 0)
+        std::cerr << oat::whoWarn(name_, std::to_string(dropped)
+                  + " samples were dropped because the recorder queue "
+                    "budget was exhausted.\n");
 }
 
 void Recorder::connectToNodes() {
@@ -142,100 +186,627 @@ void Recorder::connectToNodes() {
     if (!oat::checkSamplePeriods(all_ts, sample_rate_hz_)) {
         std::cerr << oat::Warn(oat::inconsistentSampleRateWarning(sample_rate_hz_));
     }
+
+    // One writer slot per source. Writers are created by the acquisition
+    // threads on their first recorded sample.
+    {
+        std::lock_guard<std::mutex> lk(writer_mutex_);
+        frame_writers_.resize(frame_sources_.size());
+        position_writers_.resize(position_sources_.size());
+
+        for (fvec_size_t i = 0; i != frame_sources_.size(); i++)
+            frame_writers_[i].sample_template =
+                std::make_unique<oat::Frame>(frame_sources_[i].source->retrieve().clone());
+
+        for (pvec_size_t i = 0; i != position_sources_.size(); i++)
+            position_writers_[i].sample_template =
+                std::make_unique<oat::Position2D>(*position_sources_[i].source->retrieve());
+
+        // The queue budget is split so that every SOURCE can hold the same
+        // number of samples
+        size_t sample_set_bytes = 0;
+        for (auto &s: frame_writers_)
+            sample_set_bytes += oat::sampleBytes(*s.sample_template);
+        for (auto &s: position_writers_)
+            sample_set_bytes += oat::sampleBytes(*s.sample_template);
+
+        size_t depth = std::min<uint64_t>(queue_bytes_ / sample_set_bytes,
+                                          MAX_SAMPLE_QUEUE_DEPTH);
+        if (depth == 0)
+            throw std::runtime_error("Recorder queue budget is too small to "
+                                     "hold a single sample from each SOURCE.");
+
+        // Frames that are held back for the pre-roll must fit in the queue,
+        // with room to spare for gating inputs that lag behind
+        if (gate_motion_ >= 0 || gate_position_ || !gate_region_.empty()) {
+
+            if (!std::isfinite(sample_rate_hz_) || sample_rate_hz_ <= 0)
+                throw std::runtime_error("Gated recording requires SOURCES "
+                                         "with a known sample rate.");
+
+            const uint64_t pre_roll = std::ceil(pre_roll_s_ * sample_rate_hz_);
+            const uint64_t post_roll = std::ceil(post_roll_s_ * sample_rate_hz_);
+
+            if (2 * pre_roll >= depth)
+                throw std::runtime_error("Pre-roll is longer than the recorder "
+                                         "queue. Increase --queue-size.");
+
+            int inputs = 0;
+            for (auto &s: frame_writers_) {
+                s.gated = true;
+                if (gate_motion_ >= 0)
+                    s.gate_input = inputs++;
+            }
+
+            motion_scores_.resize(inputs);
+
+            if (gate_position_ || !gate_region_.empty())
+                for (auto &s: position_writers_)
+                    s.gate_input = inputs++;
+
+            if (inputs == 0)
+                throw std::runtime_error("Gated recording requires a SOURCE "
+                                         "to evaluate the gating condition.");
+
+            for (auto &s: frame_writers_)
+                if (s.gate_input >= 0)
+                    s.gate_sample = std::make_unique<oat::Frame>(
+                        oat::allocateLike(*s.sample_template));
+
+            for (auto &s: position_writers_)
+                if (s.gate_input >= 0)
+                    s.gate_sample = std::make_unique<oat::Position2D>(
+                        oat::allocateLike(*s.sample_template));
+
+            record_gate_ = std::make_unique<oat::RecordGate>(inputs, pre_roll, post_roll);
+        }
+
+        for (auto &s: frame_writers_)
+            s.queue = std::make_unique<oat::SampleQueue<oat::Frame>>(
+                *s.sample_template, depth, overflow_policy_, save_path_);
+
+        for (auto &s: position_writers_)
+            s.queue = std::make_unique<oat::SampleQueue<oat::Position2D>>(
+                *s.sample_template, depth, overflow_policy_, save_path_);
+    }
+
+    // From here on, changes to the recording gate are aligned to samples
+    {
+        std::lock_guard<std::mutex> lk(gate_mutex_);
+        gate_armed_ = true;
+    }
+
+    // Start acquisition threads
+    for (fvec_size_t i = 0; i != frame_sources_.size(); i++) {
+        acquisition_threads_.push_back(std::thread( [this, i] {
+            acquisitionLoop(frame_sources_[i], frame_writers_[i]);
+        }));
+    }
+
+    for (pvec_size_t i = 0; i != position_sources_.size(); i++) {
+        acquisition_threads_.push_back(std::thread( [this, i] {
+            acquisitionLoop(position_sources_[i], position_writers_[i]);
+        }));
+    }
+}
+
+void Recorder::addFrameStream(const std::string &source_address,
+                              oat::FrameStream stream) {
+
+    if (stream.name.empty())
+        stream.name = stream.transform.describe();
+
+    auto &streams = frame_streams_[source_address];
+    for (auto &s : streams)
+        if (s.name == stream.name)
+            throw std::runtime_error("Frame SOURCE " + source_address
+                    + " has more than one stream named '" + stream.name
+                    + "'.");
+
+    streams.push_back(stream);
 }
 
 bool Recorder::writeStreams() {
 
-    if (record_on_ && initialization_required_) {
-        initializeRecording();
-        initialization_required_ = false;
+    std::unique_lock<std::mutex> lk(acquisition_mutex_);
+    acquisition_condition_variable_.wait_for(lk, std::chrono::milliseconds(10));
+
+    // Errors on acquisition threads are rethrown here so that they are
+    // handled by the caller
+    if (acquisition_error_)
+        std::rethrow_exception(acquisition_error_);
+
+    lk.unlock();
+
+    // Open the next file set in the background. Only one rotation is in
+    // flight at a time; later requests wait until it has completed.
+    if (rotation_requested_ && !rotating_) {
+
+        rotation_requested_ = false;
+        rotating_ = true;
+
+        if (rotation_thread_.joinable())
+            rotation_thread_.join();
+
+        rotation_thread_ = std::thread( [this] { prepareRotation(); } );
     }
 
-    // Read frames
-    for (fvec_size_t i = 0; i !=  frame_sources_.size(); i++) {
+    return source_eof_;
+}
+
+template <typename T, typename S>
+void Recorder::acquisitionLoop(oat::NamedSource<T> &s, S &slot) {
+
+    try {
+
+        auto last_sample = std::chrono::steady_clock::now();
 
-         // START CRITICAL SECTION //
-        ////////////////////////////
-        source_eof_ |= (frame_sources_[i].source->wait() == oat::NodeState::END);
+        while (running_) {
 
-        // Push newest frame into write queue
-        if (record_on_)
-            frame_writers_[i]->push(frame_sources_[i].source->clone());
+            // START CRITICAL SECTION //
+            ////////////////////////////
+            oat::NodeState state;
+            if (!s.source->wait_for(ACQUISITION_WAIT_MS, state)) {
 
-        frame_sources_[i].source->post();
-        ////////////////////////////
-        //  END CRITICAL SECTION  //
+                // Streams normally switch on their first sample of the new
+                // file set. A SOURCE that stops publishing would otherwise
+                // hold up this rotation, and so all later ones.
+                if (slot.file_set != file_set_ &&
+                    std::chrono::steady_clock::now() - last_sample
+                        >= std::chrono::milliseconds(ROTATION_IDLE_MS))
+                    switchIdleWriter(s.name, slot);
+
+                continue;
+            }
+
+            if (state == oat::NodeState::END) {
+                if (slot.file_set != file_set_)
+                    switchIdleWriter(s.name, slot);
+                source_eof_ = true;
+                break;
+            }
+
+            last_sample = std::chrono::steady_clock::now();
+
+            auto shared = s.source->retrieve();
+            const auto &sample = sharedSample(shared);
+            const uint64_t count = sample.sample().count();
+
+            // Track the newest sample number acquired from any source
+            uint64_t newest = newest_sample_;
+            while (count > newest &&
+                   !newest_sample_.compare_exchange_weak(newest, count)) { }
+
+            // The gating condition is evaluated on a copy once the node has
+            // been released
+            if (slot.gate_input >= 0)
+                oat::copySample(sample, *slot.gate_sample);
+
+            // All streams move to a new file set on the same sample
+            bool record = recordSample(count);
+            bool rotate = false;
+            uint64_t file_set = slot.file_set;
+
+            if (record) {
+
+                const uint64_t next_file_set = file_set_;
+                if (file_set != next_file_set && count >= rotation_sample_) {
+                    rotate = true;
+                    file_set = next_file_set;
+                }
+
+                // Hold the node for a single copy into the queue's pool only
+                record = slot.queue->push(sample, file_set, running_);
+            }
+
+            s.source->post();
+            ////////////////////////////
+            //  END CRITICAL SECTION  //
+
+            // Evaluate the event gate on every sample, recorded or not. The
+            // writer thread waits for this before deciding on the sample.
+            if (slot.gate_input >= 0)
+                record_gate_->update(slot.gate_input,
+                                     count,
+                                     gateCondition(*slot.gate_sample,
+                                                   slot.gate_input));
+
+            if (!record)
+                continue;
+
+            if (rotate)
+                switchWriter(slot, file_set);
+
+            if (!slot.writer)
+                initializeWriter(s.name, slot);
+
+            // Notify the writer thread that there are new queued samples
+            writer_condition_variable_.notify_one();
+        }
+
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+
+        // Error code 1 indicates a SIGINT during a call to wait(), which
+        // is normal behavior
+        if (ex.get_error_code() != 1) {
+            std::lock_guard<std::mutex> lk(acquisition_mutex_);
+            acquisition_error_ = std::current_exception();
+        }
+
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(acquisition_mutex_);
+        acquisition_error_ = std::current_exception();
     }
 
-    // Read positions
-    for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
+    acquisition_condition_variable_.notify_one();
+}
+
+bool Recorder::gateCondition(const oat::Frame &f, const int input) {
+
+    return motion_scores_[input](f) >= gate_motion_;
+}
+
+bool Recorder::gateCondition(const oat::Position2D &p, const int) {
 
-        // START CRITICAL SECTION //
-        ////////////////////////////
-        source_eof_ |= (position_sources_[i].source->wait() == oat::NodeState::END);
+    return (gate_position_ && p.position_valid) ||
+           (!gate_region_.empty() && p.region_valid && gate_region_ == p.region);
+}
 
-        // Push newest position into write queue
-        if (record_on_)
-            position_writers_[i]->push(position_sources_[i].source->clone());
+void Recorder::printQueueTelemetry(std::ostream &out) const {
 
-        position_sources_[i].source->post();
-        ////////////////////////////
-        //  END CRITICAL SECTION  //
+    // Queues exist once the gate is armed
+    {
+        std::lock_guard<std::mutex> lk(gate_mutex_);
+        if (!gate_armed_) {
+            out << "Recorder is not connected.\n";
+            return;
+        }
     }
 
-    // Notify the writer thread that there are new queued samples
-    writer_condition_variable_.notify_one();
+    auto print = [&out](const std::string &name, const oat::QueueTelemetry &t) {
+        out << name << ": depth " << t.depth << "/" << t.capacity
+            << ", high-water " << t.high_water
+            << ", blocked " << t.blocked
+            << ", dropped " << t.dropped
+            << ", spilled " << t.spilled << "\n";
+    };
+
+    for (fvec_size_t i = 0; i != frame_writers_.size(); i++)
+        if (frame_writers_[i].queue)
+            print(frame_sources_[i].name, frame_writers_[i].queue->telemetry());
+
+    for (pvec_size_t i = 0; i != position_writers_.size(); i++)
+        if (position_writers_[i].queue)
+            print(position_sources_[i].name, position_writers_[i].queue->telemetry());
+}
 
-    return source_eof_;
+void Recorder::stopAcquisition() {
+
+    // NOTE: running_ must be false. Acquisition threads wait on their
+    // SOURCEs with a timeout, so they see it and exit even if the SINK is not
+    // publishing.
+    for (auto &t : acquisition_threads_)
+        t.join();
+}
+
+bool Recorder::record_on() const {
+
+    std::lock_guard<std::mutex> lk(gate_mutex_);
+    return record_on_;
+}
+
+void Recorder::set_record_on(const bool value) {
+
+    std::lock_guard<std::mutex> lk(gate_mutex_);
+
+    if (gate_armed_) {
+        record_on_before_gate_ =
+            newest_sample_ >= gate_sample_ ? record_on_ : record_on_before_gate_;
+        gate_sample_ = newest_sample_ + 1;
+    } else {
+        record_on_before_gate_ = value;
+    }
+
+    record_on_ = value;
+}
+
+bool Recorder::recordSample(const uint64_t count) {
+
+    std::lock_guard<std::mutex> lk(gate_mutex_);
+    return count >= gate_sample_ ? record_on_ : record_on_before_gate_;
 }
 
 void Recorder::writeLoop() {
 
     while (running_) {
 
-        std::unique_lock<std::mutex> lk(writer_mutex_);
-        writer_condition_variable_.wait_for(lk, std::chrono::milliseconds(10));
+        // Writers replaced by a file rotation. Closing a file can be slow
+        // (e.g. video encoder flush) so it is done outside the lock.
+        std::vector<std::unique_ptr<oat::FrameWriter>> retired_frame_writers;
+        std::vector<std::unique_ptr<oat::Writer<oat::Position2D>>>
+            retired_position_writers;
+
+        {
+            std::unique_lock<std::mutex> lk(writer_mutex_);
+            writer_condition_variable_.wait_for(lk, std::chrono::milliseconds(10));
+
+            for (auto &s: frame_writers_)
+                writeSlot(s, retired_frame_writers);
 
-        //std::cout << "Dummy write.\n";
-        for (auto &w: frame_writers_)
-            w->write();
+            for (auto &s: position_writers_)
+                writeSlot(s, retired_position_writers);
 
-        for (auto &w: position_writers_)
-            w->write();
+            checkFileLimits();
+        }
     }
 }
 
-// TODO: clone()'s below are not thread safe
-void Recorder::initializeRecording() {
+void Recorder::checkFileLimits() {
+
+    // NOTE: writer_mutex_ must be held
 
-    std::string timestamp = oat::createTimeStamp();
+    if (rotating_ || rotation_requested_ || file_timestamp_.empty() ||
+        !record_on())
+        return;
 
-    // Create a writer for each position source
-    for (auto &p : position_sources_) {
+    auto now = std::chrono::steady_clock::now();
 
-        std::string file_path = generateFileName(timestamp, p.name, ".json");
-        position_writers_.push_back(std::make_unique<oat::PositionWriter>(file_path));
-        position_writers_.back()->initialize(p.name, p.source->clone());
-        // TODO: Hack.
-        position_writers_.back()->set_verbose_file(verbose_file_);
+    if (max_file_duration_s_ > 0 &&
+        std::chrono::duration<double>(now - file_set_start_).count()
+            >= max_file_duration_s_) {
+        rotation_requested_ = true;
+        return;
     }
 
-    // Create a writer for each frame source
-    for (auto &s : frame_sources_) {
+    // File sizes are polled once per second
+    if (max_file_bytes_ > 0 &&
+        now - last_size_check_ >= std::chrono::seconds(1)) {
+
+        last_size_check_ = now;
+
+        uint64_t bytes = 0;
+        struct stat st;
+
+        auto add = [&bytes, &st](const std::vector<std::string> &files) {
+            for (auto &f : files)
+                if (stat(f.c_str(), &st) == 0)
+                    bytes += st.st_size;
+        };
+
+        for (auto &s: frame_writers_)
+            if (s.writer) add(s.writer->files());
+
+        for (auto &s: position_writers_)
+            if (s.writer) add(s.writer->files());
+
+        if (bytes >= max_file_bytes_)
+            rotation_requested_ = true;
+    }
+}
+
+void Recorder::prepareRotation() {
+
+    try {
+
+        std::vector<std::unique_ptr<oat::Frame>> frame_templates;
+        std::vector<std::unique_ptr<oat::Position2D>> position_templates;
+
+        // Only streams that are already being written get a pre-opened file.
+        // Others are created on their first recorded sample.
+        {
+            std::lock_guard<std::mutex> lk(writer_mutex_);
+
+            for (auto &s: frame_writers_)
+                frame_templates.push_back(s.writer ?
+                    std::make_unique<oat::Frame>(*s.sample_template) : nullptr);
+
+            for (auto &s: position_writers_)
+                position_templates.push_back(s.writer ?
+                    std::make_unique<oat::Position2D>(*s.sample_template) : nullptr);
+        }
+
+        // Open the next file set without holding any locks
+        const std::string timestamp = oat::createTimeStamp();
+
+        std::vector<std::unique_ptr<oat::FrameWriter>> next_frame_writers;
+        for (fvec_size_t i = 0; i != frame_templates.size(); i++) {
+            next_frame_writers.push_back(frame_templates[i] ?
+                makeWriter(timestamp, frame_sources_[i].name,
+                           *frame_templates[i], true) : nullptr);
+        }
+
+        std::vector<std::unique_ptr<oat::Writer<oat::Position2D>>> next_position_writers;
+        for (pvec_size_t i = 0; i != position_templates.size(); i++) {
+            next_position_writers.push_back(position_templates[i] ?
+                makeWriter(timestamp, position_sources_[i].name,
+                           *position_templates[i], true) : nullptr);
+        }
+
+        // Commit. Streams switch on the sample following the newest sample
+        // acquired from any SOURCE.
+        std::lock_guard<std::mutex> lk(writer_mutex_);
+
+        pending_switches_ = 0;
+
+        for (fvec_size_t i = 0; i != next_frame_writers.size(); i++) {
+            if (next_frame_writers[i]) {
+                frame_writers_[i].next_writer = std::move(next_frame_writers[i]);
+                pending_switches_++;
+            }
+        }
+
+        for (pvec_size_t i = 0; i != next_position_writers.size(); i++) {
+            if (next_position_writers[i]) {
+                position_writers_[i].next_writer = std::move(next_position_writers[i]);
+                pending_switches_++;
+            }
+        }
+
+        file_timestamp_ = timestamp;
+        file_set_start_ = std::chrono::steady_clock::now();
+        rotation_sample_ = newest_sample_ + 1;
+        ++file_set_;
+
+        if (pending_switches_ == 0)
+            rotating_ = false;
 
-        std::string file_path = generateFileName(timestamp, s.name, ".avi");
-        frame_writers_.push_back(std::make_unique<oat::FrameWriter>(file_path));
-        frame_writers_.back()->initialize(s.name, s.source->clone());
+    } catch (...) {
+        std::lock_guard<std::mutex> lk(acquisition_mutex_);
+        acquisition_error_ = std::current_exception();
     }
 }
 
+template <typename S>
+void Recorder::switchWriter(S &slot, const uint64_t file_set) {
+
+    std::unique_lock<std::mutex> lk(writer_mutex_);
+
+    // Should not happen unless rotations are very close together. Wait for
+    // the writer thread to close the file set before last.
+    while (slot.retired_writer) {
+        lk.unlock();
+        writer_condition_variable_.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lk.lock();
+    }
+
+    // The writer thread writes the samples that are still queued for the
+    // old file and then closes it. If the next file was not pre-opened, it
+    // is created by the caller.
+    slot.retired_writer = std::move(slot.writer);
+
+    if (slot.next_writer) {
+        slot.writer = std::move(slot.next_writer);
+        if (--pending_switches_ == 0)
+            rotating_ = false;
+    }
+
+    slot.file_set = file_set;
+}
+
+template <typename S>
+void Recorder::switchIdleWriter(const std::string &source_name, S &slot) {
+
+    bool pending = false;
+    {
+        std::lock_guard<std::mutex> lk(writer_mutex_);
+        pending = slot.next_writer != nullptr;
+    }
+
+    if (pending)
+        std::cerr << oat::whoWarn(name_, "File rotation is still pending on "
+                  + source_name + ", which is not publishing. Switching its "
+                    "stream to the new file set without waiting for a "
+                    "sample.\n");
+
+    switchWriter(slot, file_set_);
+}
+
+template <typename S>
+void Recorder::initializeWriter(const std::string &source_name, S &slot) {
+
+    std::lock_guard<std::mutex> lk(writer_mutex_);
+
+    if (file_timestamp_.empty()) {
+        file_timestamp_ = oat::createTimeStamp();
+        file_set_start_ = std::chrono::steady_clock::now();
+    }
+
+    slot.writer = makeWriter(file_timestamp_, source_name,
+                             *slot.sample_template, false);
+}
+
+template <typename T, typename W>
+void Recorder::writeSlot(oat::WriterSlot<T, W> &slot,
+                         std::vector<std::unique_ptr<W>> &retired) {
+
+    oat::drainWriterSlot(slot,
+                         slot.gated ? record_gate_.get() : nullptr,
+                         retired);
+
+    // Runs on every wakeup of the writer thread, even if nothing was written
+    if (slot.writer)
+        slot.writer->poll();
+}
+
+std::unique_ptr<oat::Writer<oat::Position2D>>
+Recorder::makeWriter(const std::string &timestamp,
+                     const std::string &source_name,
+                     const oat::Position2D &p,
+                     const bool unique) {
+
+    std::unique_ptr<oat::Writer<oat::Position2D>> w;
+
+    switch (position_format_) {
+        case PositionFileFormat::JSON :
+        {
+            std::string file_path =
+                generateFileName(timestamp, source_name, ".json", unique);
+            auto jw = std::make_unique<oat::PositionWriter>(file_path);
+            jw->set_verbose_file(verbose_file_);
+            w = std::move(jw);
+            break;
+        }
+        case PositionFileFormat::BINARY :
+        {
+            std::string file_path =
+                generateFileName(timestamp, source_name, ".pos", unique);
+            w = std::make_unique<oat::BinaryPositionWriter>(file_path,
+                                                            position_columns_);
+            break;
+        }
+        case PositionFileFormat::NDJSON :
+        {
+            std::string file_path =
+                generateFileName(timestamp, source_name, ".ndjson", unique);
+            auto jw = std::make_unique<oat::NDJSONPositionWriter>(file_path);
+            jw->set_verbose_file(verbose_file_);
+            w = std::move(jw);
+            break;
+        }
+    }
+
+    w->initialize(source_name, p);
+    return w;
+}
+
+std::unique_ptr<oat::FrameWriter>
+Recorder::makeWriter(const std::string &timestamp,
+                     const std::string &source_name,
+                     const oat::Frame &f,
+                     const bool unique) {
+
+    std::vector<std::string> paths;
+    std::vector<oat::FrameTransform> transforms;
+
+    auto streams = frame_streams_.find(source_name);
+    if (streams == frame_streams_.end()) {
+        paths.push_back(generateFileName(timestamp, source_name, ".avi", unique));
+        transforms.push_back(oat::FrameTransform());
+    } else {
+        for (auto &s : streams->second) {
+            std::string stream_name = source_name;
+            if (!s.name.empty())
+                stream_name += "_" + s.name;
+            paths.push_back(generateFileName(timestamp, stream_name, ".avi", unique));
+            transforms.push_back(s.transform);
+        }
+    }
+
+    auto w = std::make_unique<oat::FrameWriter>(paths, transforms);
+    w->initialize(source_name, f);
+    return w;
+}
+
 /**
  * @brief Generate unified file name for all streams.
+ * @param unique Ensure that path is unique, even if overwriting is allowed.
  * @return Recording path.
  */
 std::string Recorder::generateFileName(const std::string timestamp, 
                                        const std::string &source_name,
-                                       const std::string &extension) {
+                                       const std::string &extension,
+                                       const bool unique) {
 
     std::string base_fid = source_name;
     if (!file_name_.empty())
@@ -253,7 +824,8 @@ std::string Recorder::generateFileName(const std::string timestamp,
                 "with error " + std::to_string(err));
     }
 
-    if (!allow_overwrite_)
+    // Rotated files must never overwrite the file set they replace
+    if (!allow_overwrite_ || unique)
        oat::ensureUniquePath(full_path);
 
     return full_path;
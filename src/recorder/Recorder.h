@@ -20,11 +20,22 @@
 #ifndef OAT_RECORDER_H
 #define OAT_RECORDER_H
 
+#include "BinaryPositionWriter.h"
 #include "FrameWriter.h"
+#include "NDJSONPositionWriter.h"
 #include "PositionWriter.h"
+#include "RecordGate.h"
+#include "SampleQueue.h"
+#include "WriterSlot.h"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <exception>
+#include <iosfwd>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <boost/any.hpp>
@@ -40,6 +51,15 @@ namespace oat {
 // Forward decl.
 class SharedFrameHeader;
 
+/**
+ * Position file formats.
+ */
+enum class PositionFileFormat {
+    JSON = 0,   //!< Single JSON document (default)
+    BINARY = 1, //!< Fixed-size binary records (see oat::poslog)
+    NDJSON = 2  //!< One JSON document per line
+};
+
 /**
  * Position and frame recorder.
  */
@@ -71,19 +91,15 @@ public:
 
     /**
      * Recorder SOURCEs must be able to connect to a NODEs from
-     * which to receive positions and frames.
+     * which to receive positions and frames. Once connected, each SOURCE is
+     * serviced by its own acquisition thread.
      */
     void connectToNodes(void);
 
-    /** 
-     * @brief Create and initialize recording file(s). Must be called
-     * before writeStreams.
-     * 
-     */
-    void initializeRecording(void);
-
-    /** Collect frames and positions from SOURCES. Write frames and positions
-     * to file.  
+    /**
+     * Monitor the acquisition threads, which collect frames and positions
+     * from SOURCES and push them to the file writers. Blocks for at most 10
+     * ms.
      * @return SOURCE end-of-stream signal. If true, this component should
      * exit.
      */
@@ -96,14 +112,49 @@ public:
     std::string name(void) { return name_; }
 
     // Accessors
-    bool record_on(void) const { return record_on_; }
-    void set_record_on(const bool value) { record_on_ = value; }
+    bool record_on(void) const;
+    void set_record_on(const bool value);
     bool source_eof(void) const { return source_eof_; }
+
+    /**
+     * Request that recording continues in a new set of files. The next file
+     * set is opened in the background and all streams switch to it on the
+     * same sample, without pausing acquisition.
+     */
+    void requestRotation(void) { rotation_requested_ = true; }
+
+    /**
+     * Print the state of each SOURCE's sample queue.
+     * @param out Output stream.
+     */
+    void printQueueTelemetry(std::ostream &out) const;
+
     void set_save_path(const std::string &value) { save_path_ = value; }
     void set_file_name(const std::string &value) { file_name_ = value; }
     void set_prepend_timestamp(const bool value) { prepend_timestamp_ = value; }
     void set_allow_overwrite(const bool value) { allow_overwrite_ = value; } 
     void set_verbose_file(const bool value) { verbose_file_ = value; };
+    void set_position_format(const PositionFileFormat value) { position_format_ = value; }
+    void set_position_columns(const uint32_t value) { position_columns_ = value; }
+    void set_max_file_bytes(const uint64_t value) { max_file_bytes_ = value; }
+    void set_max_file_duration(const double value) { max_file_duration_s_ = value; }
+    void set_queue_bytes(const uint64_t value) { queue_bytes_ = value; }
+    void set_overflow_policy(const OverflowPolicy value) { overflow_policy_ = value; }
+    void set_gate_motion(const double value) { gate_motion_ = value; }
+    void set_gate_position(const bool value) { gate_position_ = value; }
+    void set_gate_region(const std::string &value) { gate_region_ = value; }
+    void set_pre_roll(const double value) { pre_roll_s_ = value; }
+    void set_post_roll(const double value) { post_roll_s_ = value; }
+
+    /**
+     * Record an additional, transformed, video stream from a frame SOURCE.
+     * SOURCES without added streams are recorded as is.
+     * @param source_address Address of the frame SOURCE.
+     * @param stream Stream name and transform. If the name is empty, it is
+     * derived from the transform.
+     */
+    void addFrameStream(const std::string &source_address,
+                        oat::FrameStream stream);
 
 private:
 
@@ -115,8 +166,16 @@ private:
     std::atomic<bool> running_ {true};
 
     // Recording gate can be toggled on and off interactively from other
-    // threads and processes
-    std::atomic<bool> record_on_ {true};
+    // threads and processes. A toggle takes effect at gate_sample_, the
+    // sample number following the newest sample acquired from any SOURCE, so
+    // that all files start and stop on the same sample.
+    mutable std::mutex gate_mutex_;
+    bool record_on_ {true};
+    bool record_on_before_gate_ {true};
+    bool gate_armed_ {false};
+    uint64_t gate_sample_ {0};
+    std::atomic<uint64_t> newest_sample_ {0};
+    bool recordSample(const uint64_t count);
 
     // Sample rate of this recorder
     // The true sample rate is enforced by the slowest SOURCE since all SOURCEs
@@ -140,21 +199,108 @@ private:
     // write pos_xy when pos_ok = false?
     bool verbose_file_ {true};
 
-    // Files must be initialized before first write
-    bool initialization_required_ {true};
+    // Position file format
+    PositionFileFormat position_format_ {PositionFileFormat::JSON};
+
+    // Columns written to binary position files
+    uint32_t position_columns_ {oat::poslog::ALL};
+
+    // Memory budget, in bytes, shared by the sample queues of all SOURCEs,
+    // and what to do when it is exhausted
+    uint64_t queue_bytes_ {DEFAULT_QUEUE_BYTES};
+    OverflowPolicy overflow_policy_ {OverflowPolicy::BLOCK};
+
+    // Event gated frame recording. Frames are only written while a frame
+    // SOURCE's motion score is at least gate_motion_ (negative to disable),
+    // or a position SOURCE is valid (gate_position_) or in gate_region_
+    // (empty to disable), give or take the pre and post roll. 
+    double gate_motion_ {-1.0};
+    bool gate_position_ {false};
+    std::string gate_region_ {""};
+    double pre_roll_s_ {0.0};
+    double post_roll_s_ {0.0};
+    std::unique_ptr<oat::RecordGate> record_gate_;
+    std::vector<oat::MotionScore> motion_scores_;
+    bool gateCondition(const oat::Frame &f, const int input);
+    bool gateCondition(const oat::Position2D &p, const int input);
+
+    // Timestamp shared by all files in the current file set
+    std::string file_timestamp_ {""};
+
+    // File rotation. Once the current file set exceeds max_file_bytes_ or
+    // max_file_duration_s_ (0 for no limit), or when requested, the next file
+    // set is opened by rotation_thread_. All streams switch to it at
+    // rotation_sample_, or after ROTATION_IDLE_MS without a sample. File sets
+    // are numbered by file_set_.
+    uint64_t max_file_bytes_ {0};
+    double max_file_duration_s_ {0.0};
+    std::chrono::steady_clock::time_point file_set_start_;
+    std::chrono::steady_clock::time_point last_size_check_;
+    std::atomic<bool> rotation_requested_ {false};
+    std::atomic<bool> rotating_ {false};
+    std::atomic<uint64_t> rotation_sample_ {std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> file_set_ {0};
+    int pending_switches_ {0};
+    std::thread rotation_thread_;
+    void prepareRotation(void);
+    void checkFileLimits(void);
 
     // Source end of file flag
-    bool source_eof_ {false};
+    std::atomic<bool> source_eof_ {false};
 
     // Executed by writer_thread_
     void writeLoop(void);
 
+    // Acquisition threading. Each SOURCE is waited on, cloned and released
+    // by its own thread so that a late SOURCE does not delay the others.
+    std::vector<std::thread> acquisition_threads_;
+    std::mutex acquisition_mutex_;
+    std::condition_variable acquisition_condition_variable_;
+    std::exception_ptr acquisition_error_;
+
+    // Executed by each acquisition thread
+    template <typename T, typename S>
+    void acquisitionLoop(oat::NamedSource<T> &source, S &slot);
+    void stopAcquisition(void);
+
+    using PositionWriterSlot =
+        oat::WriterSlot<oat::Position2D, oat::Writer<oat::Position2D>>;
+    using FrameWriterSlot = oat::WriterSlot<oat::Frame, oat::FrameWriter>;
+
+    // Create and initialize the file writer for a SOURCE
+    template <typename S>
+    void initializeWriter(const std::string &source_name, S &slot);
+
+    // Swap in the writer for a new file set
+    template <typename S>
+    void switchWriter(S &slot, const uint64_t file_set);
+
+    // Swap in the writer for the new file set on a stream whose SOURCE has
+    // stopped publishing. Called by the stream's acquisition thread.
+    template <typename S>
+    void switchIdleWriter(const std::string &source_name, S &slot);
+
+    // Pass queued samples to the writers and poll them. writer_mutex_ must
+    // be held.
+    template <typename T, typename W>
+    void writeSlot(oat::WriterSlot<T, W> &slot, std::vector<std::unique_ptr<W>> &retired);
+
+    // Open a file writer
+    std::unique_ptr<oat::Writer<oat::Position2D>>
+    makeWriter(const std::string &timestamp,
+               const std::string &source_name,
+               const oat::Position2D &p,
+               const bool unique);
+    std::unique_ptr<oat::FrameWriter>
+    makeWriter(const std::string &timestamp,
+               const std::string &source_name,
+               const oat::Frame &f,
+               const bool unique);
+
     // TODO: Somehow make list of generic Writers
-    // File writers
-    std::vector< std::unique_ptr
-               < oat::PositionWriter > > position_writers_;
-    std::vector< std::unique_ptr
-               < oat::FrameWriter > > frame_writers_;
+    // File writers, one slot per SOURCE
+    std::vector<PositionWriterSlot> position_writers_;
+    std::vector<FrameWriterSlot> frame_writers_;
 
     // File-writer threading
     std::thread writer_thread_;
@@ -164,12 +310,16 @@ private:
     // Frame sources
     oat::NamedSourceList<oat::SharedFrameHeader> frame_sources_;
 
+    // Video streams recorded from each frame source, by address
+    std::map<std::string, std::vector<oat::FrameStream>> frame_streams_;
+
     // Position sources
     oat::NamedSourceList<oat::Position2D> position_sources_;
 
     std::string generateFileName(const std::string timestamp, 
                                  const std::string &source_name,
-                                 const std::string &extension); 
+                                 const std::string &extension,
+                                 const bool unique = false); 
 };
 
 }      /* namespace oat */
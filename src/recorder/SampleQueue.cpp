@@ -0,0 +1,193 @@
+//******************************************************************************
+//* File:   SampleQueue.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#include "SampleQueue.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+
+namespace oat {
+
+// Fixed size representation of a spilled position
+struct PositionSpill {
+    oat::Sample sample;
+    int32_t unit;
+    bool position_valid;
+    bool velocity_valid;
+    bool heading_valid;
+    bool region_valid;
+    bool position_held;
+    double position[2];
+    double velocity[2];
+    double heading[2];
+    char region[100];
+};
+
+static void writeAll(const int fd, off_t offset, const char *data, size_t n) {
+
+    while (n > 0) {
+        ssize_t rc = pwrite(fd, data, n, offset);
+        if (rc < 0)
+            throw std::runtime_error("Could not write to recorder spill file: "
+                                     + std::string(strerror(errno)));
+        data += rc;
+        offset += rc;
+        n -= rc;
+    }
+}
+
+static void readAll(const int fd, off_t offset, char *data, size_t n) {
+
+    while (n > 0) {
+        ssize_t rc = pread(fd, data, n, offset);
+        if (rc <= 0)
+            throw std::runtime_error("Could not read from recorder spill file.");
+        data += rc;
+        offset += rc;
+        n -= rc;
+    }
+}
+
+size_t sampleBytes(const oat::Frame &f) {
+
+    return sizeof(oat::Sample) + f.total() * f.elemSize();
+}
+
+size_t sampleBytes(const oat::Position2D &) {
+
+    return sizeof(PositionSpill);
+}
+
+oat::Frame allocateLike(const oat::Frame &f) {
+
+    return f.clone();
+}
+
+oat::Position2D allocateLike(const oat::Position2D &p) {
+
+    return p;
+}
+
+void copySample(const oat::Frame &from, oat::Frame &to) {
+
+    // Pool elements have the same size and type as the SOURCE, so this does
+    // not reallocate
+    from.copyTo(to);
+}
+
+void copySample(const oat::Position2D &from, oat::Position2D &to) {
+
+    to = from;
+}
+
+void spillSample(const int fd, const off_t offset, const oat::Frame &f) {
+
+    writeAll(fd, offset,
+             reinterpret_cast<const char *>(&f.sample()), sizeof(oat::Sample));
+
+    const size_t row_bytes = f.cols * f.elemSize();
+    off_t o = offset + sizeof(oat::Sample);
+
+    if (f.isContinuous()) {
+        writeAll(fd, o, reinterpret_cast<const char *>(f.data), f.rows * row_bytes);
+    } else {
+        for (int i = 0; i < f.rows; i++, o += row_bytes)
+            writeAll(fd, o, reinterpret_cast<const char *>(f.ptr(i)), row_bytes);
+    }
+}
+
+void spillSample(const int fd, const off_t offset, const oat::Position2D &p) {
+
+    PositionSpill s;
+    std::memset(&s, 0, sizeof(s));
+    s.sample = p.sample();
+    s.unit = static_cast<int32_t>(p.unit_of_length());
+    s.position_valid = p.position_valid;
+    s.velocity_valid = p.velocity_valid;
+    s.heading_valid = p.heading_valid;
+    s.region_valid = p.region_valid;
+    s.position_held = p.position_held;
+    s.position[0] = p.position.x;
+    s.position[1] = p.position.y;
+    s.velocity[0] = p.velocity.x;
+    s.velocity[1] = p.velocity.y;
+    s.heading[0] = p.heading.x;
+    s.heading[1] = p.heading.y;
+    std::memcpy(s.region, p.region, sizeof(s.region));
+
+    writeAll(fd, offset, reinterpret_cast<const char *>(&s), sizeof(s));
+}
+
+void unspillSample(const int fd, const off_t offset, oat::Frame &f) {
+
+    readAll(fd, offset,
+            reinterpret_cast<char *>(&f.sample()), sizeof(oat::Sample));
+
+    const size_t row_bytes = f.cols * f.elemSize();
+    off_t o = offset + sizeof(oat::Sample);
+
+    if (f.isContinuous()) {
+        readAll(fd, o, reinterpret_cast<char *>(f.data), f.rows * row_bytes);
+    } else {
+        for (int i = 0; i < f.rows; i++, o += row_bytes)
+            readAll(fd, o, reinterpret_cast<char *>(f.ptr(i)), row_bytes);
+    }
+}
+
+void unspillSample(const int fd, const off_t offset, oat::Position2D &p) {
+
+    PositionSpill s;
+    readAll(fd, offset, reinterpret_cast<char *>(&s), sizeof(s));
+
+    p.sample() = s.sample;
+    p.setCoordSystem(static_cast<oat::DistanceUnit>(s.unit), p.homography());
+    p.position_valid = s.position_valid;
+    p.velocity_valid = s.velocity_valid;
+    p.heading_valid = s.heading_valid;
+    p.region_valid = s.region_valid;
+    p.position_held = s.position_held;
+    p.position = oat::Point2D(s.position[0], s.position[1]);
+    p.velocity = oat::Velocity2D(s.velocity[0], s.velocity[1]);
+    p.heading = oat::UnitVector2D(s.heading[0], s.heading[1]);
+    std::memcpy(p.region, s.region, sizeof(p.region));
+    p.region[sizeof(p.region) - 1] = '\0';
+}
+
+int openSpillFile(const std::string &directory) {
+
+    std::string path = directory + "/.oat-record-spill-XXXXXX";
+    std::vector<char> tmpl(path.begin(), path.end());
+    tmpl.push_back('\0');
+
+    int fd = mkstemp(tmpl.data());
+    if (fd < 0)
+        throw std::runtime_error("Could not create recorder spill file in "
+                                 + directory);
+
+    // The file is removed once it is closed
+    unlink(tmpl.data());
+
+    return fd;
+}
+
+} /* namespace oat */
@@ -0,0 +1,305 @@
+//******************************************************************************
+//* File:   SampleQueue.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_SAMPLEQUEUE_H
+#define OAT_SAMPLEQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <unistd.h>
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/datatypes/Position2D.h"
+
+namespace oat {
+
+// Constants
+static constexpr uint64_t DEFAULT_QUEUE_BYTES {512 << 20};
+static constexpr size_t MAX_SAMPLE_QUEUE_DEPTH {1 << 16};
+static constexpr size_t MAX_SPILLED_SAMPLES {1 << 16};
+
+/**
+ * What a SampleQueue does with a sample when its pool is exhausted.
+ */
+enum class OverflowPolicy {
+    BLOCK = 0,  //!< Hold the SOURCE until a pool element is free
+    DROP = 1,   //!< Discard the sample and count it
+    SPILL = 2   //!< Append the sample to a temporary file
+};
+
+/**
+ * Queue occupancy and overflow statistics.
+ */
+struct QueueTelemetry {
+    size_t capacity {0};    //!< Number of preallocated samples
+    size_t depth {0};       //!< Samples currently queued
+    size_t high_water {0};  //!< Maximum depth observed
+    uint64_t blocked {0};   //!< Samples that waited for a free pool element
+    uint64_t dropped {0};   //!< Samples discarded
+    uint64_t spilled {0};   //!< Samples written to the spill file
+};
+
+// Sample type specific operations used by SampleQueue
+size_t sampleBytes(const oat::Frame &f);
+size_t sampleBytes(const oat::Position2D &p);
+oat::Frame allocateLike(const oat::Frame &f);
+oat::Position2D allocateLike(const oat::Position2D &p);
+void copySample(const oat::Frame &from, oat::Frame &to);
+void copySample(const oat::Position2D &from, oat::Position2D &to);
+void spillSample(const int fd, const off_t offset, const oat::Frame &f);
+void spillSample(const int fd, const off_t offset, const oat::Position2D &p);
+void unspillSample(const int fd, const off_t offset, oat::Frame &f);
+void unspillSample(const int fd, const off_t offset, oat::Position2D &p);
+
+/**
+ * @brief Open an anonymous temporary file for spilled samples.
+ * @param directory Folder in which to create the file.
+ * @return File descriptor.
+ */
+int openSpillFile(const std::string &directory);
+
+/**
+ * Single producer, single consumer sample queue backed by a pool of samples
+ * that is allocated up front. Pushing a sample copies it into a free pool
+ * element, so that queuing does not allocate. Pool elements are returned to
+ * the pool once the consumer has processed them.
+ */
+template <typename T>
+class SampleQueue {
+
+    // Entries refer to a pool element or to a sample in the spill file
+    struct Entry {
+        size_t index;
+        off_t offset;
+        uint64_t tag;
+    };
+
+    static constexpr size_t SPILLED {std::numeric_limits<size_t>::max()};
+
+public:
+
+    /**
+     * @brief Sample queue.
+     * @param prototype Sample used to size the pool elements.
+     * @param capacity Number of pool elements.
+     * @param policy Overflow policy.
+     * @param spill_directory Folder used for spilled samples.
+     */
+    SampleQueue(const T &prototype,
+                const size_t capacity,
+                const OverflowPolicy policy,
+                const std::string &spill_directory) :
+      policy_(policy)
+    , capacity_(capacity)
+    , free_(capacity)
+    , entries_(policy == OverflowPolicy::SPILL ?
+               capacity + MAX_SPILLED_SAMPLES : capacity)
+    , spill_sample_(allocateLike(prototype))
+    {
+        pool_.reserve(capacity);
+        for (size_t i = 0; i < capacity; i++) {
+            pool_.push_back(allocateLike(prototype));
+            free_.push(i);
+        }
+
+        if (policy_ == OverflowPolicy::SPILL) {
+            spill_fd_ = openSpillFile(spill_directory);
+            spill_bytes_ = sampleBytes(prototype);
+        }
+    }
+
+    ~SampleQueue() {
+        if (spill_fd_ >= 0)
+            close(spill_fd_);
+    }
+
+    SampleQueue(const SampleQueue &) = delete;
+    SampleQueue & operator=(const SampleQueue &) = delete;
+
+    /**
+     * @brief Copy a sample into the queue. Producer thread only.
+     * @param sample Sample to queue.
+     * @param tag Value passed back to the consumer along with the sample.
+     * @param running Blocking pushes give up when this becomes false.
+     * @return False if the sample was dropped.
+     */
+    bool push(const T &sample,
+              const uint64_t tag,
+              const std::atomic<bool> &running) {
+
+        size_t index;
+        if (!free_.pop(index)) {
+
+            switch (policy_) {
+                case OverflowPolicy::BLOCK :
+                {
+                    blocked_++;
+                    while (!free_.pop(index)) {
+                        if (!running)
+                            return false;
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    break;
+                }
+                case OverflowPolicy::DROP :
+                {
+                    dropped_++;
+                    return false;
+                }
+                case OverflowPolicy::SPILL :
+                {
+                    return spill(sample, tag);
+                }
+            }
+        }
+
+        copySample(sample, pool_[index]);
+        entries_.push(Entry {index, 0, tag});
+        updateDepth();
+
+        return true;
+    }
+
+    /**
+     * @brief Pass queued samples, in order, to a function until the queue is
+     * empty or the function rejects a sample. A rejected sample is offered
+     * again on the next call. Consumer thread only.
+     * @param f Function with signature bool(const T &sample, uint64_t tag).
+     * @return Number of samples consumed.
+     */
+    template <typename F>
+    size_t consume(F f) {
+
+        size_t n = 0;
+        while (has_pending_ || entries_.pop(pending_)) {
+
+            has_pending_ = true;
+
+            const T *sample;
+            if (pending_.index == SPILLED) {
+                if (!pending_loaded_) {
+                    unspillSample(spill_fd_, pending_.offset, spill_sample_);
+                    pending_loaded_ = true;
+                }
+                sample = &spill_sample_;
+            } else {
+                sample = &pool_[pending_.index];
+            }
+
+            if (!f(*sample, pending_.tag))
+                break;
+
+            if (pending_.index == SPILLED) {
+                pending_loaded_ = false;
+                spill_outstanding_--;
+            } else {
+                free_.push(pending_.index);
+            }
+
+            has_pending_ = false;
+            depth_--;
+            n++;
+        }
+
+        return n;
+    }
+
+    QueueTelemetry telemetry(void) const {
+
+        QueueTelemetry t;
+        t.capacity = capacity_;
+        t.depth = depth_;
+        t.high_water = high_water_;
+        t.blocked = blocked_;
+        t.dropped = dropped_;
+        t.spilled = spilled_;
+        return t;
+    }
+
+private:
+
+    const OverflowPolicy policy_;
+    const size_t capacity_;
+
+    // Preallocated samples and indices of those that are free
+    std::vector<T> pool_;
+    boost::lockfree::spsc_queue<size_t> free_;
+
+    // Queued samples, in order
+    boost::lockfree::spsc_queue<Entry> entries_;
+
+    // Entry offered to the consumer but not yet accepted
+    Entry pending_ {0, 0, 0};
+    bool has_pending_ {false};
+    bool pending_loaded_ {false};
+
+    // Spill file. The write offset is reset once all spilled samples have
+    // been consumed.
+    int spill_fd_ {-1};
+    size_t spill_bytes_ {0};
+    off_t spill_end_ {0};
+    std::atomic<size_t> spill_outstanding_ {0};
+    T spill_sample_;
+
+    // Telemetry
+    std::atomic<size_t> depth_ {0};
+    std::atomic<size_t> high_water_ {0};
+    std::atomic<uint64_t> blocked_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+    std::atomic<uint64_t> spilled_ {0};
+
+    bool spill(const T &sample, const uint64_t tag) {
+
+        if (spill_outstanding_ == 0)
+            spill_end_ = 0;
+
+        if (!entries_.write_available()) {
+            dropped_++;
+            return false;
+        }
+
+        spillSample(spill_fd_, spill_end_, sample);
+        spill_outstanding_++;
+        entries_.push(Entry {SPILLED, spill_end_, tag});
+        spill_end_ += spill_bytes_;
+        spilled_++;
+        updateDepth();
+
+        return true;
+    }
+
+    void updateDepth(void) {
+
+        size_t d = ++depth_;
+        size_t hw = high_water_;
+        while (d > hw && !high_water_.compare_exchange_weak(hw, d)) { }
+    }
+};
+
+}      /* namespace oat */
+#endif /* OAT_SAMPLEQUEUE_H */
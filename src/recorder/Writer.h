@@ -21,8 +21,7 @@
 #define OAT_WRITER_H
 
 #include <string>
-//#include <chrono>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <vector>
 #include <opencv2/videoio.hpp>
 #include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
@@ -32,19 +31,15 @@
 #include "../../lib/datatypes/Position2D.h"
 
 namespace oat {
-namespace blf = boost::lockfree;
-
-static constexpr int SAMPLE_BUFFER_SIZE {1000};
 
 /**
- * Generic, abstract file writer for a single data source
+ * Generic, abstract file writer for a single data source. Samples are queued
+ * by the recorder (see oat::SampleQueue) and passed to the writer one at a
+ * time from the writer thread.
  */
 template <typename T>
 class Writer {
 
-using SPSCBuffer =
-    boost::lockfree::spsc_queue<T, blf::capacity<SAMPLE_BUFFER_SIZE>>;
-
 public:
 
     Writer(const std::string &path) :
@@ -54,30 +49,41 @@ public:
             throw (std::runtime_error("Write permission denied for " + path_));
     }
 
+    virtual ~Writer() { }
+
     /**
      * @brief Create and initialize recording file(s). Must be called
-     * before writeStreams.
+     * before write.
      */
     virtual void initialize(const std::string &source_name,
                             const T &sample_template) = 0;
 
     /**
-     * @brief Flush internal sample buffer to file.
+     * @brief Write a sample to file.
      */
-    virtual void write(void) = 0;
+    virtual void write(const T &sample) = 0;
 
     /**
-     * @brief Push a sample onto the internal, lock-free, thread-safe buffer
-     * @return False if there is an overflow condition. True otherwise.
+     * @brief Called in place of write for samples that are not recorded
+     * because the record gate is closed.
      */
-    void push(const T &sample) {
-        if (!buffer_.push(sample)) {
-            throw (std::runtime_error("Record buffer overrun. You can:\n"
-                                      " - decrease the sample rate\n"
-                                      " - use multiple recorders on multiple disks\n"
-                                      " - or, get a faster hard disk"));
-        }
-    }
+    virtual void skip(const T & /*sample*/) { }
+
+    /**
+     * @brief Called periodically by the writer thread, whether or not
+     * samples have been written, so that buffered data can be flushed.
+     */
+    virtual void poll(void) { }
+
+    /**
+     * @brief Path of the file this writer is writing to.
+     */
+    const std::string & path(void) const { return path_; }
+
+    /**
+     * @brief Paths of all files this writer is writing to.
+     */
+    virtual std::vector<std::string> files(void) const { return {path_}; }
 
 protected:
 
@@ -85,11 +91,6 @@ protected:
      * @brief Fully qualified to file this writer is writting to.
      */
     std::string path_ {""};
-
-    /** 
-     * @brief Lock-free, thread-safe buffer which is flushed to file with each call to write. 
-     */
-    SPSCBuffer buffer_;
 };
 
 }      /* namespace oat */
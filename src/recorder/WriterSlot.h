@@ -0,0 +1,114 @@
+//******************************************************************************
+//* File:   WriterSlot.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*****************************************************************************
+
+#ifndef OAT_WRITERSLOT_H
+#define OAT_WRITERSLOT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RecordGate.h"
+#include "SampleQueue.h"
+
+namespace oat {
+
+/**
+ * Sample queue and file writers serving a single SOURCE. Writers are
+ * guarded by the recorder's writer mutex, except that the SOURCE's
+ * acquisition thread may read members it is the only one to modify. Queued
+ * samples are tagged with the file set they belong to.
+ */
+template <typename T, typename W>
+struct WriterSlot {
+    std::unique_ptr<oat::SampleQueue<T>> queue; //!< Samples waiting to be written
+    std::unique_ptr<W> writer;          //!< Writer for the current file set
+    std::unique_ptr<W> next_writer;     //!< Pre-opened writer for the next file set
+    std::unique_ptr<W> retired_writer;  //!< Replaced writer waiting to be closed
+    std::unique_ptr<T> sample_template; //!< Copy of the SOURCE's sample at connection
+    std::unique_ptr<T> gate_sample;     //!< Copy evaluated by the gate after release
+    uint64_t file_set {0};              //!< File set that writer belongs to
+    bool gated {false};                 //!< Samples are subject to the record gate
+    int gate_input {-1};                //!< Input to the record gate, -1 if none
+};
+
+/**
+ * @brief Pass queued samples to a slot's writers, in order. Samples tagged
+ * with an older file set go to the retired writer. Samples for a file set
+ * that the slot has not switched to yet, or that has no writer yet, stay
+ * queued. So do samples whose gate decision depends on samples that have not
+ * been acquired yet.
+ * @param slot Slot to write.
+ * @param gate Event gate deciding which samples are written, or nullptr to
+ * write all of them.
+ * @param retired Receives the retired writer once every sample of its file
+ * set has been written.
+ */
+template <typename T, typename W>
+void drainWriterSlot(WriterSlot<T, W> &slot,
+                     oat::RecordGate *gate,
+                     std::vector<std::unique_ptr<W>> &retired) {
+
+    if (!slot.queue)
+        return;
+
+    // Set once a sample of the slot's current file set is reached. Samples
+    // are queued in order, so none remain for the retired writer from then on.
+    bool retired_done = false;
+
+    slot.queue->consume([&slot, &retired_done, gate](const T &sample,
+                                                      const uint64_t file_set) {
+
+        W *w = nullptr;
+        if (file_set >= slot.file_set) {
+            retired_done = true;
+            if (file_set == slot.file_set)
+                w = slot.writer.get();
+        } else {
+            w = slot.retired_writer.get();
+        }
+
+        if (w == nullptr)
+            return false;
+
+        if (gate == nullptr) {
+            w->write(sample);
+            return true;
+        }
+
+        switch (gate->decide(sample.sample().count())) {
+            case oat::RecordGate::Decision::WAIT :
+                return false;
+            case oat::RecordGate::Decision::COMMIT :
+                w->write(sample);
+                return true;
+            case oat::RecordGate::Decision::SKIP :
+                w->skip(sample);
+                return true;
+        }
+
+        return false;
+    });
+
+    if (slot.retired_writer && retired_done)
+        retired.push_back(std::move(slot.retired_writer));
+}
+
+}      /* namespace oat */
+#endif /* OAT_WRITERSLOT_H */
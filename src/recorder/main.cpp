@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <csignal>
+#include <cstdio>
+#include <sstream>
 #include <thread>
 #include <pthread.h> // TODO: POSIX specific
 #include <functional>
@@ -49,6 +51,17 @@ std::string save_path;
 bool allow_overwrite = false;
 bool prepend_timestamp = false;
 bool concise_file = false;
+oat::PositionFileFormat position_format = oat::PositionFileFormat::JSON;
+uint32_t position_columns = oat::poslog::ALL;
+uint64_t max_file_bytes = 0;
+double max_file_duration = 0.0;
+uint64_t queue_bytes = oat::DEFAULT_QUEUE_BYTES;
+oat::OverflowPolicy overflow_policy = oat::OverflowPolicy::BLOCK;
+double gate_motion = -1.0;
+bool gate_position = false;
+std::string gate_region;
+double pre_roll = 0.0;
+double post_roll = 0.0;
 
 // ZMQ stream
 using zmq_istream_t = boost::iostreams::stream<oat::zmq_istream>;
@@ -86,6 +99,53 @@ void cleanup(std::thread &proc_thread) {
     proc_thread.join();
 }
 
+// Parse a frame stream specifier, 'SOURCE:TRANSFORM[:TRANSFORM...]'
+std::pair<std::string, oat::FrameStream>
+parseFrameStream(const std::string &spec) {
+
+    std::vector<std::string> tokens;
+    std::stringstream ss(spec);
+    std::string t;
+    while (std::getline(ss, t, ':'))
+        tokens.push_back(t);
+
+    if (tokens.size() < 2 || tokens[0].empty())
+        throw std::runtime_error("Invalid frame stream '" + spec + "'.");
+
+    oat::FrameStream stream;
+    cv::Rect crop;
+    int decimation = 1;
+    bool grayscale = false;
+
+    for (size_t i = 1; i < tokens.size(); i++) {
+
+        const auto &tok = tokens[i];
+        char c;
+
+        if (tok == "gray") {
+            grayscale = true;
+        } else if (tok.compare(0, 5, "name=") == 0 && tok.size() > 5) {
+            stream.name = tok.substr(5);
+        } else if (std::sscanf(tok.c_str(), "decimate=%d%c", &decimation, &c) == 1) {
+            if (decimation < 1)
+                throw std::runtime_error("Invalid decimation in frame stream '"
+                                         + spec + "'.");
+        } else if (std::sscanf(tok.c_str(), "crop=%d,%d,%d,%d%c",
+                               &crop.x, &crop.y, &crop.width, &crop.height, &c) == 4) {
+            if (crop.x < 0 || crop.y < 0 || crop.width <= 0 || crop.height <= 0)
+                throw std::runtime_error("Invalid crop region in frame stream '"
+                                         + spec + "'.");
+        } else {
+            throw std::runtime_error("Invalid transform '" + tok
+                                     + "' in frame stream '" + spec + "'.");
+        }
+    }
+
+    stream.transform = oat::FrameTransform(crop, decimation, grayscale);
+
+    return std::make_pair(tokens[0], stream);
+}
+
 // Processing loop
 void run(std::shared_ptr<oat::Recorder>& recorder) {
 
@@ -111,8 +171,11 @@ int main(int argc, char *argv[]) {
     std::signal(SIGINT, sigHandler);
 
     std::vector<std::string> frame_sources;
+    std::vector<std::pair<std::string, oat::FrameStream>> frame_streams;
     std::vector<std::string> position_sources;
     std::string rpc_endpoint;
+    std::string position_format_str;
+    std::string overflow_str;
 
     try {
 
@@ -126,6 +189,16 @@ int main(int argc, char *argv[]) {
         configuration.add_options()
                 ("frame-sources,s", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the FRAME SOURCES that supply images to save to video.")
+                ("frame-streams", po::value< std::vector<std::string> >()->multitoken(),
+                 "Additional videos recorded from FRAME SOURCES, with transforms "
+                 "applied by the recorder before encoding. Each is specified as "
+                 "'SOURCE:TRANSFORM[:TRANSFORM...]', where TRANSFORM is "
+                 "'crop=X,Y,W,H' to keep a region of the frame, 'decimate=N' "
+                 "to reduce resolution N-fold by averaging, 'gray' to convert "
+                 "to grayscale, or 'name=NAME' to set the suffix of the video "
+                 "file name. Transforms are applied in that order. A SOURCE "
+                 "that is not also listed in --frame-sources is only recorded "
+                 "through its streams.")
                 ("position-sources,p", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the POSITION SOURCES that supply object positions "
                 "to be recorded.")
@@ -149,6 +222,57 @@ int main(int argc, char *argv[]) {
                  "means that position objects will be of variable size depending on the "
                  "validity on whether a position was detected or not, potentially "
                  "complicating file parsing.")
+                ("position-format", po::value<std::string>(&position_format_str),
+                 "Position file format. Values: 'json' (default) writes a single "
+                 "JSON document per position source. 'binary' writes a "
+                 "self-describing header followed by fixed-size records, one per "
+                 "sample, which can be memory mapped and converted to JSON using "
+                 "'oat posiconv'. 'ndjson' writes a header line followed by one "
+                 "compact JSON object per sample and line, so that files can be "
+                 "read while they are being written and remain readable if the "
+                 "recorder exits unexpectedly.")
+                ("position-columns", po::value< std::vector<std::string> >()->multitoken(),
+                 "Optional columns written to binary position files. Values: "
+                 "'pos', 'vel', 'head', 'reg'. Sample number, time, unit and "
+                 "validity flags are always written. Defaults to all columns.")
+                ("max-file-size", po::value<double>(),
+                 "Maximum size, in MB, of a file set. Once the files written "
+                 "by the recorder exceed this size, recording continues in a "
+                 "new set of files. All streams switch to the new files on "
+                 "the same sample and no samples are lost.")
+                ("max-file-duration", po::value<double>(&max_file_duration),
+                 "Maximum duration, in seconds, of a file set. Once exceeded, "
+                 "recording continues in a new set of files as for "
+                 "--max-file-size.")
+                ("queue-size", po::value<double>(),
+                 "Memory, in MB, used to queue samples waiting to be written to "
+                 "disk. It is allocated up front and shared between all "
+                 "SOURCES. Defaults to 512 MB.")
+                ("overflow", po::value<std::string>(&overflow_str),
+                 "What to do with a new sample when the queue is full. Values: "
+                 "'block' (default) holds the SOURCE, and therefore everything "
+                 "upstream of it, until there is room. 'drop' discards the "
+                 "sample; dropped samples are counted and reported. 'spill' "
+                 "writes the sample to a temporary file in the save folder, "
+                 "from which it is written in order once the disk catches up.")
+                ("gate-motion", po::value<double>(&gate_motion),
+                 "Only record frames while there is motion in a FRAME SOURCE. "
+                 "Motion is the mean absolute difference, in grayscale units "
+                 "(0-255), between consecutive decimated frames, and must be "
+                 "at least this value. Positions are always recorded. Skipped "
+                 "frames are listed in a .gaps.csv file next to each video.")
+                ("gate-position",
+                 "Only record frames while a POSITION SOURCE holds a valid "
+                 "position. Can be combined with other gating options.")
+                ("gate-region", po::value<std::string>(&gate_region),
+                 "Only record frames while a POSITION SOURCE is in the "
+                 "specified region. Can be combined with other gating options.")
+                ("pre-roll", po::value<double>(&pre_roll),
+                 "When gating, seconds of frames to record before the gating "
+                 "condition becomes met. Must fit in half of --queue-size.")
+                ("post-roll", po::value<double>(&post_roll),
+                 "When gating, seconds of frames to record after the gating "
+                 "condition stops being met.")
                 ("interactive", "Start recorder with interactive controls enabled.")
                 ("rpc-endpoint", po::value<std::string>(&rpc_endpoint),
                  "Yield interactive control of the recorder to a remote ZMQ REQ "
@@ -185,7 +309,9 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (!variable_map.count("position-sources") && !variable_map.count("frame-sources")) {
+        if (!variable_map.count("position-sources") &&
+            !variable_map.count("frame-sources") &&
+            !variable_map.count("frame-streams")) {
             printUsage(std::cout, all_options);
             std::cerr << oat::Error("At least a single POSITION SOURCE or FRAME SOURCE must be specified.\n");
             return -1;
@@ -235,6 +361,24 @@ int main(int argc, char *argv[]) {
             }
         }
 
+        if (variable_map.count("frame-streams")) {
+
+            // Full frames are recorded alongside the streams of SOURCES that
+            // were also specified using --frame-sources
+            for (auto &s : frame_sources)
+                frame_streams.push_back(std::make_pair(s, oat::FrameStream()));
+
+            for (auto &spec : variable_map["frame-streams"].as< std::vector<std::string> >()) {
+
+                frame_streams.push_back(parseFrameStream(spec));
+
+                const auto &s = frame_streams.back().first;
+                if (std::find(frame_sources.begin(), frame_sources.end(), s)
+                        == frame_sources.end())
+                    frame_sources.push_back(s);
+            }
+        }
+
         if (variable_map.count("date"))
             prepend_timestamp = true;
 
@@ -244,6 +388,96 @@ int main(int argc, char *argv[]) {
         if (variable_map.count("concise-file"))
             concise_file = true;
 
+        if (variable_map.count("position-format")) {
+
+            if (position_format_str == "json") {
+                position_format = oat::PositionFileFormat::JSON;
+            } else if (position_format_str == "binary") {
+                position_format = oat::PositionFileFormat::BINARY;
+            } else if (position_format_str == "ndjson") {
+                position_format = oat::PositionFileFormat::NDJSON;
+            } else {
+                printUsage(std::cout, all_options);
+                std::cerr << oat::Error("Invalid position-format specified.\n");
+                return -1;
+            }
+        }
+
+        if (variable_map.count("position-columns")) {
+
+            std::unordered_map<std::string, uint32_t> column_map;
+            column_map["pos"] = oat::poslog::POSITION;
+            column_map["vel"] = oat::poslog::VELOCITY;
+            column_map["head"] = oat::poslog::HEADING;
+            column_map["reg"] = oat::poslog::REGION;
+
+            position_columns = 0;
+            for (auto &c : variable_map["position-columns"].as< std::vector<std::string> >()) {
+
+                if (!column_map.count(c)) {
+                    printUsage(std::cout, all_options);
+                    std::cerr << oat::Error("Invalid position column '" + c + "' specified.\n");
+                    return -1;
+                }
+
+                position_columns |= column_map[c];
+            }
+        }
+
+        if (variable_map.count("max-file-size")) {
+
+            auto mb = variable_map["max-file-size"].as<double>();
+            if (mb <= 0) {
+                printUsage(std::cout, all_options);
+                std::cerr << oat::Error("--max-file-size must be positive.\n");
+                return -1;
+            }
+
+            max_file_bytes = static_cast<uint64_t>(mb * 1e6);
+        }
+
+        if (variable_map.count("queue-size")) {
+
+            auto mb = variable_map["queue-size"].as<double>();
+            if (mb <= 0) {
+                printUsage(std::cout, all_options);
+                std::cerr << oat::Error("--queue-size must be positive.\n");
+                return -1;
+            }
+
+            queue_bytes = static_cast<uint64_t>(mb * 1e6);
+        }
+
+        if (variable_map.count("overflow")) {
+
+            if (overflow_str == "block") {
+                overflow_policy = oat::OverflowPolicy::BLOCK;
+            } else if (overflow_str == "drop") {
+                overflow_policy = oat::OverflowPolicy::DROP;
+            } else if (overflow_str == "spill") {
+                overflow_policy = oat::OverflowPolicy::SPILL;
+            } else {
+                printUsage(std::cout, all_options);
+                std::cerr << oat::Error("Invalid overflow policy '" + overflow_str + "'.\n");
+                return -1;
+            }
+        }
+
+        if (variable_map.count("gate-position"))
+            gate_position = true;
+
+        if (pre_roll < 0 || post_roll < 0) {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("--pre-roll and --post-roll must be positive.\n");
+            return -1;
+        }
+
+        if (max_file_duration < 0) {
+            printUsage(std::cout, all_options);
+            std::cerr << oat::Error("--max-file-duration must be positive.\n");
+            return -1;
+        }
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return -1;
@@ -258,108 +492,113 @@ int main(int argc, char *argv[]) {
     // The business
     try {
 
-        int rc = 1;
-        while (rc == 1) {
+        auto recorder =
+            std::make_shared<oat::Recorder>(position_sources, frame_sources);
+        name = recorder->name();
 
-            // We may be coming around for another recording so reset quit
-            // flag
-            quit = 0;
+        // Tell user
+        if (!frame_sources.empty()) {
 
-            auto recorder =
-                std::make_shared<oat::Recorder>(position_sources, frame_sources);
-            name = recorder->name();
+            std::cout << oat::whoMessage(recorder->name(),
+                    "Listening to frame sources ");
 
-            // Tell user
-            if (!frame_sources.empty()) {
+            for (auto s : frame_sources)
+                std::cout << oat::sourceText(s) << " ";
 
-                std::cout << oat::whoMessage(recorder->name(),
-                        "Listening to frame sources ");
+            std::cout << ".\n";
+        }
 
-                for (auto s : frame_sources)
-                    std::cout << oat::sourceText(s) << " ";
+        if (!position_sources.empty()) {
 
-                std::cout << ".\n";
-            }
+            std::cout << oat::whoMessage(recorder->name(),
+                    "Listening to position sources ");
 
-            if (!position_sources.empty()) {
+            for (auto s : position_sources)
+                std::cout << oat::sourceText(s) << " ";
 
-                std::cout << oat::whoMessage(recorder->name(),
-                        "Listening to position sources ");
+            std::cout << ".\n";
+        }
 
-                for (auto s : position_sources)
-                    std::cout << oat::sourceText(s) << " ";
+        std::cout << oat::whoMessage(recorder->name(),
+                "Press CTRL+C to exit.\n");
+
+        // Set recording parameters
+        recorder->set_save_path(save_path);
+        recorder->set_file_name(file_name);
+        recorder->set_prepend_timestamp(prepend_timestamp);
+        recorder->set_allow_overwrite(allow_overwrite);
+        recorder->set_verbose_file(!concise_file);
+        recorder->set_position_format(position_format);
+        recorder->set_position_columns(position_columns);
+        recorder->set_max_file_bytes(max_file_bytes);
+        recorder->set_max_file_duration(max_file_duration);
+        recorder->set_queue_bytes(queue_bytes);
+        recorder->set_overflow_policy(overflow_policy);
+        recorder->set_gate_motion(gate_motion);
+        recorder->set_gate_position(gate_position);
+        recorder->set_gate_region(gate_region);
+        recorder->set_pre_roll(pre_roll);
+        recorder->set_post_roll(post_roll);
+
+        for (auto &s : frame_streams)
+            recorder->addFrameStream(s.first, s.second);
+
+        switch (control_mode)
+        {
+            case ControlMode::NONE :
+            {
+                // Start the recorder w/o controls
+                run(recorder);
 
-                std::cout << ".\n";
+                break;
             }
-
-            std::cout << oat::whoMessage(recorder->name(),
-                    "Press CTRL+C to exit.\n");
-
-            // Set recording parameters
-            recorder->set_save_path(save_path);
-            recorder->set_file_name(file_name);
-            recorder->set_prepend_timestamp(prepend_timestamp);
-            recorder->set_allow_overwrite(allow_overwrite);
-            recorder->set_verbose_file(!concise_file);
-
-            switch (control_mode)
+            case ControlMode::LOCAL :
             {
-                case ControlMode::NONE :
-                {
-                    // Start the recorder w/o controls
-                    run(recorder);
-                    rc = 0;
-
-                    break;
+                // For interactive control, recorder must be started by user
+                recorder->set_record_on(false);
+
+                // Start recording in background
+                std::thread process(run, std::ref(recorder));
+                try {
+                  // Interact using stdin
+                  oat::printInteractiveUsage(std::cout);
+                  oat::controlRecorder(std::cin, std::cout, *recorder, true);
+                } catch (...) {
+                  // Interrupt and join threads
+                  cleanup(process);
+                  throw;
                 }
-                case ControlMode::LOCAL :
-                {
-                    // For interactive control, recorder must be started by user
-                    recorder->set_record_on(false);
-
-                    // Start recording in background
-                    std::thread process(run, std::ref(recorder));
-                    try {
-                      // Interact using stdin
-                      oat::printInteractiveUsage(std::cout);
-                      rc = oat::controlRecorder(std::cin, std::cout, *recorder, true);
-                    } catch (...) {
-                      // Interrupt and join threads
-                      cleanup(process);
-                      throw;
-                    }
-                    cleanup(process);
+                cleanup(process);
 
-                    break;
-                }
-                case ControlMode::RPC :
-                {
-                    // For interactive control, recorder must be started by user
-                    recorder->set_record_on(false);
-
-                    // Start recording in background
-                    std::thread process(run, std::ref(recorder));
-
-                    try {
-                        auto ctx = std::make_shared<zmq::context_t>(1);
-                        auto sock = std::make_shared<zmq::socket_t>(*ctx, ZMQ_REP);
-                        sock->bind(rpc_endpoint);
-                        zmq_istream_t in(ctx, sock);
-                        zmq_ostream_t out(ctx, sock);
-                        oat::printRemoteUsage(std::cout);
-                        rc = oat::controlRecorder(in, out, *recorder, false);
-                    } catch (const zmq::error_t &ex) {
-                        std::cerr << oat::whoError(recorder->name(), "zeromq error: "
-                                + std::string(ex.what())) << "\n";
-                        cleanup(process);
-                        return -1;
-                    }
-
-                    // Interupt and join threads
+                break;
+            }
+            case ControlMode::RPC :
+            {
+                // For interactive control, recorder must be started by user
+                recorder->set_record_on(false);
+
+                // Start recording in background
+                std::thread process(run, std::ref(recorder));
+
+                try {
+                    auto ctx = std::make_shared<zmq::context_t>(1);
+                    auto sock = std::make_shared<zmq::socket_t>(*ctx, ZMQ_REP);
+                    sock->bind(rpc_endpoint);
+                    zmq_istream_t in(ctx, sock);
+                    zmq_ostream_t out(ctx, sock);
+                    oat::printRemoteUsage(std::cout);
+                    oat::controlRecorder(in, out, *recorder, false);
+                } catch (const zmq::error_t &ex) {
+                    std::cerr << oat::whoError(recorder->name(), "zeromq error: "
+                            + std::string(ex.what())) << "\n";
                     cleanup(process);
-
-                    break;
+                    return -1;
                 }
+
+                // Interupt and join threads
+                cleanup(process);
+
+                break;
             }
         }
 
@@ -0,0 +1,3 @@
+oat posidet hsv raw pos -c test.toml posidet-hsv-bands &
+sleep 1
+time oat frameserve test raw -f $1 -c test.toml test
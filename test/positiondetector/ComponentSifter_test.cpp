@@ -0,0 +1,202 @@
+//******************************************************************************
+//* File:   ComponentSifter_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Blobs2D.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../src/positiondetector/ComponentSifter.h"
+
+// Connected component as found by cv::connectedComponentsWithStats
+struct Component {
+    double area;
+    cv::Point2d centroid;
+    cv::Rect box;
+};
+
+// Components with area in [min_area, max_area), largest first
+static std::vector<Component> referenceComponents(const cv::Mat &frame,
+                                                  const double min_area,
+                                                  const double max_area,
+                                                  const cv::Point &offset) {
+
+    cv::Mat labels, stats, centroids;
+    const int n = cv::connectedComponentsWithStats(frame, labels, stats,
+                                                   centroids, 8, CV_32S);
+
+    std::vector<Component> components;
+    for (int i = 1; i < n; i++) {
+
+        const double a = stats.at<int>(i, cv::CC_STAT_AREA);
+        if (a < min_area || a >= max_area)
+            continue;
+
+        components.push_back({a,
+            cv::Point2d(centroids.at<double>(i, 0) + offset.x,
+                        centroids.at<double>(i, 1) + offset.y),
+            cv::Rect(stats.at<int>(i, cv::CC_STAT_LEFT) + offset.x,
+                     stats.at<int>(i, cv::CC_STAT_TOP) + offset.y,
+                     stats.at<int>(i, cv::CC_STAT_WIDTH),
+                     stats.at<int>(i, cv::CC_STAT_HEIGHT))});
+    }
+
+    std::stable_sort(components.begin(), components.end(),
+        [](const Component &a, const Component &b) { return a.area > b.area; });
+
+    return components;
+}
+
+static bool near(const cv::Point2d &a, const cv::Point2d &b) {
+    return std::abs(a.x - b.x) < 1e-9 && std::abs(a.y - b.y) < 1e-9;
+}
+
+// Sift a frame and check the position, area and blob list against the
+// reference components. Components of equal area may be listed in any
+// order, so each blob only needs to match some component of its area.
+static void checkSifter(oat::ComponentSifter &sifter,
+                        const cv::Mat &frame,
+                        const double min_area = 0,
+                        const double max_area = 1e9,
+                        const cv::Point &offset = cv::Point()) {
+
+    const auto ref = referenceComponents(frame, min_area, max_area, offset);
+
+    oat::Position2D position("test");
+    oat::Blobs2D blobs("test");
+    double area = -1;
+    sifter(frame, position, area, min_area, max_area, offset, &blobs);
+
+    if (ref.empty()) {
+        REQUIRE (!position.position_valid);
+        REQUIRE (area == 0);
+        REQUIRE (blobs.empty());
+        return;
+    }
+
+    REQUIRE (position.position_valid);
+    REQUIRE (area == ref[0].area);
+    REQUIRE (std::any_of(ref.begin(), ref.end(), [&](const Component &c) {
+        return c.area == area && near(c.centroid, position.position);
+    }));
+
+    REQUIRE (blobs.size() == std::min(ref.size(), blobs.capacity()));
+    for (size_t i = 0; i < blobs.size(); i++) {
+
+        const oat::Blob2D &b = blobs[i];
+        REQUIRE (b.area == ref[i].area);
+        REQUIRE (std::any_of(ref.begin(), ref.end(), [&](const Component &c) {
+            return c.area == b.area
+                && c.box == b.bounding_box
+                && near(c.centroid, b.centroid);
+        }));
+    }
+}
+
+// Binary frame with foreground density percent
+static cv::Mat randomFrame(cv::RNG &rng,
+                           const cv::Size &size,
+                           const int density) {
+
+    cv::Mat noise(size, CV_8UC1);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 100);
+    return noise < density;
+}
+
+SCENARIO ("ComponentSifter matches cv::connectedComponentsWithStats.", "[ComponentSifter]") {
+
+    GIVEN ("Random binary frames of odd and even size.") {
+
+        cv::RNG rng(0x0a7);
+        std::vector<cv::Mat> frames;
+        for (const auto &s : {cv::Size(64, 48), cv::Size(63, 47), cv::Size(1, 33), cv::Size(40, 1)})
+            for (const int d : {5, 20, 45, 60})
+                frames.push_back(randomFrame(rng, s, d));
+
+        oat::ComponentSifter sifter;
+
+        WHEN ("Components are labeled on a single band.") {
+
+            THEN ("Areas, centroids and bounding boxes match.") {
+                for (const auto &f : frames)
+                    checkSifter(sifter, f);
+            }
+        }
+
+        WHEN ("Components are labeled on several bands.") {
+
+            THEN ("Components that cross band boundaries are joined.") {
+                for (const int b : {2, 3, 7, 64}) {
+                    sifter.set_bands(b);
+                    for (const auto &f : frames)
+                        checkSifter(sifter, f);
+                }
+            }
+        }
+
+        WHEN ("An area range and an offset are given.") {
+
+            THEN ("Only components within the range are kept, offset.") {
+                for (const int b : {1, 3}) {
+                    sifter.set_bands(b);
+                    for (const auto &f : frames)
+                        checkSifter(sifter, f, 3, 20, cv::Point(5, -7));
+                }
+            }
+        }
+    }
+
+    GIVEN ("Components that touch the frame edges.") {
+
+        cv::Mat frame = cv::Mat::zeros(31, 42, CV_8UC1);
+
+        // Border, a diagonal that is only 8-connected, and corner pixels
+        cv::rectangle(frame, cv::Rect(0, 0, 42, 31), cv::Scalar(255));
+        for (int i = 3; i < 28; i++)
+            frame.at<uint8_t>(i, i + 6) = 255;
+        frame.at<uint8_t>(2, 2) = 255;
+        frame.at<uint8_t>(28, 39) = 255;
+
+        oat::ComponentSifter sifter;
+
+        THEN ("Components match on one or several bands.") {
+            for (const int b : {1, 2, 5}) {
+                sifter.set_bands(b);
+                checkSifter(sifter, frame);
+            }
+        }
+    }
+
+    GIVEN ("Empty and full frames.") {
+
+        oat::ComponentSifter sifter;
+        sifter.set_bands(4);
+
+        THEN ("No component or a single component is found.") {
+            checkSifter(sifter, cv::Mat::zeros(24, 17, CV_8UC1));
+            checkSifter(sifter, cv::Mat(24, 17, CV_8UC1, cv::Scalar(255)));
+        }
+    }
+}
@@ -0,0 +1,200 @@
+//******************************************************************************
+//* File:   DifferenceEngine_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cmath>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/positiondetector/DifferenceEngine.h"
+
+static constexpr int THRESHOLD {40};
+
+// The engine rounds the blurred value half up whereas cv::blur may round it
+// differently, so the comparison is only exact if no box mean of 0/255
+// pixels lies near the rounding boundary of the threshold.
+static bool unambiguous(const int threshold, const cv::Size &blur) {
+
+    const int n = blur.area();
+    for (int c = 0; c <= n; c++)
+        if (std::abs(255.0 * c / n - (threshold + 0.5)) < 0.1)
+            return false;
+
+    return true;
+}
+
+// The same steps using OpenCV
+static cv::Mat referenceMask(const cv::Mat &frame,
+                             const cv::Mat &old_frame,
+                             const cv::Rect &roi,
+                             const int threshold,
+                             const cv::Size &blur) {
+
+    cv::Mat gray, old;
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        cv::cvtColor(old_frame, old, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = frame;
+        old = old_frame;
+    }
+
+    // absdiff allocates a new matrix, so the region of interest is
+    // filtered in isolation from the rest of the frame
+    cv::Mat diff, mask;
+    cv::absdiff(gray(roi), old(roi), diff);
+    cv::threshold(diff, mask, threshold, 255, cv::THRESH_BINARY);
+
+    if (blur.area() > 0) {
+        cv::Mat blurred;
+        cv::blur(mask, blurred, blur);
+        cv::threshold(blurred, mask, threshold, 255, cv::THRESH_BINARY);
+    }
+
+    return mask;
+}
+
+// Run a frame sequence through a new engine and compare each mask with the
+// reference
+static void checkEngine(const std::vector<cv::Mat> &frames,
+                        const cv::Rect &roi,
+                        const cv::Size &blur,
+                        const int lag,
+                        const int bands,
+                        const cv::Rect &bounds = cv::Rect()) {
+
+    oat::DifferenceEngine engine;
+    engine.set_bounds(bounds);
+    engine.set_threshold(THRESHOLD);
+    engine.set_blur(blur);
+    engine.set_lag(lag);
+    engine.set_bands(bands);
+
+    cv::Mat mask;
+    for (size_t k = 0; k < frames.size(); k++) {
+
+        const bool ready = engine.apply(frames[k], roi, mask);
+
+        REQUIRE (mask.size() == roi.size());
+        REQUIRE (mask.type() == CV_8UC1);
+
+        if (k < static_cast<size_t>(lag)) {
+            REQUIRE (!ready);
+            REQUIRE (cv::countNonZero(mask) == 0);
+            continue;
+        }
+
+        REQUIRE (ready);
+        const cv::Mat ref = referenceMask(frames[k], frames[k - lag], roi,
+                                          THRESHOLD, blur);
+        REQUIRE (cv::countNonZero(mask != ref) == 0);
+    }
+}
+
+// Whole region, a region touching its right and bottom edges, and an odd
+// sized region touching its left edge
+static std::vector<cv::Rect> regions(const cv::Rect &r) {
+
+    return {r,
+            cv::Rect(r.x + r.width / 3, r.y + r.height / 4,
+                     r.width - r.width / 3, r.height - r.height / 4),
+            cv::Rect(r.x, r.y + 1, r.width / 2 + 1, r.height / 2 + 1)};
+}
+
+static std::vector<cv::Rect> regions(const cv::Size &s) {
+    return regions(cv::Rect(cv::Point(0, 0), s));
+}
+
+SCENARIO ("DifferenceEngine matches cvtColor, absdiff, threshold and blur.", "[DifferenceEngine]") {
+
+    GIVEN ("Random BGR and grayscale frame sequences of odd and even size.") {
+
+        cv::RNG rng(0x0a7);
+        std::vector<std::vector<cv::Mat>> sequences;
+        for (const auto &s : {cv::Size(64, 48), cv::Size(63, 37)}) {
+            for (const int type : {CV_8UC3, CV_8UC1}) {
+
+                std::vector<cv::Mat> frames(6);
+                for (auto &f : frames) {
+                    f.create(s, type);
+                    rng.fill(f, cv::RNG::UNIFORM,
+                             cv::Scalar::all(0), cv::Scalar::all(256));
+                }
+                sequences.push_back(frames);
+            }
+        }
+
+        WHEN ("Frames are differenced without a box filter.") {
+
+            THEN ("Masks match on the whole frame and on regions at its edges.") {
+                for (const auto &frames : sequences)
+                    for (const auto &roi : regions(frames[0].size()))
+                        for (const int lag : {1, 2})
+                            checkEngine(frames, roi, cv::Size(0, 0), lag, 1);
+            }
+        }
+
+        WHEN ("Masks are smoothed by odd and even box filters.") {
+
+            const std::vector<cv::Size> blurs {cv::Size(3, 3),
+                                               cv::Size(4, 4),
+                                               cv::Size(5, 3),
+                                               cv::Size(2, 6)};
+
+            THEN ("Masks match, including at the region edges.") {
+                for (const auto &b : blurs) {
+                    REQUIRE (unambiguous(THRESHOLD, b));
+                    for (const auto &frames : sequences)
+                        for (const auto &roi : regions(frames[0].size()))
+                            checkEngine(frames, roi, b, 1, 1);
+                }
+            }
+        }
+
+        WHEN ("The engine is confined to bounds within the frame.") {
+
+            THEN ("Masks of regions within the bounds match.") {
+                for (const auto &frames : sequences) {
+
+                    const cv::Size s = frames[0].size();
+                    const cv::Rect bounds(s.width / 4, 3, s.width / 2 + 1, s.height - 3);
+
+                    for (const auto &b : {cv::Size(0, 0), cv::Size(4, 4)})
+                        for (const auto &roi : regions(bounds))
+                            for (const int bands : {1, 3})
+                                checkEngine(frames, roi, b, 1, bands, bounds);
+                }
+            }
+        }
+
+        WHEN ("Frames are processed in several bands.") {
+
+            THEN ("Masks match those of a single band.") {
+                for (const int bands : {2, 3, 8})
+                    for (const auto &b : {cv::Size(0, 0), cv::Size(3, 3), cv::Size(4, 4)})
+                        for (const auto &frames : sequences)
+                            for (const auto &roi : regions(frames[0].size()))
+                                checkEngine(frames, roi, b, 2, bands);
+            }
+        }
+    }
+}
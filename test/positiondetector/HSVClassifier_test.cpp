@@ -0,0 +1,114 @@
+//******************************************************************************
+//* File:   HSVClassifier_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/positiondetector/HSVClassifier.h"
+
+// Classify a frame and compare each band's mask with cvtColor followed by
+// inRange for that band alone
+static void checkClassifier(const oat::HSVClassifier &classifier,
+                            const cv::Mat &frame,
+                            const std::vector<cv::Scalar> &min,
+                            const std::vector<cv::Scalar> &max) {
+
+    std::vector<cv::Mat> masks;
+    classifier.apply(frame, masks);
+    REQUIRE (masks.size() == min.size());
+
+    cv::Mat hsv, ref;
+    cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
+
+    for (size_t k = 0; k < masks.size(); k++) {
+
+        cv::inRange(hsv, min[k], max[k], ref);
+
+        REQUIRE (masks[k].size() == frame.size());
+        REQUIRE (masks[k].type() == CV_8UC1);
+        REQUIRE (cv::countNonZero(masks[k] != ref) == 0);
+    }
+}
+
+SCENARIO ("HSVClassifier masks match cvtColor followed by inRange.", "[HSVClassifier]") {
+
+    GIVEN ("Random BGR frames, and slices of every G, R pair at several B.") {
+
+        cv::RNG rng(0x0a7);
+        std::vector<cv::Mat> frames;
+        for (const auto &s : {cv::Size(64, 48), cv::Size(63, 37)}) {
+            cv::Mat f(s, CV_8UC3);
+            rng.fill(f, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+            frames.push_back(f);
+        }
+
+        for (const int b : {0, 127, 255}) {
+            cv::Mat f(256, 256, CV_8UC3);
+            for (int g = 0; g < 256; g++)
+                for (int r = 0; r < 256; r++)
+                    f.at<cv::Vec3b>(g, r) = cv::Vec3b(b, g, r);
+            frames.push_back(f);
+        }
+
+        oat::HSVClassifier classifier;
+
+        WHEN ("Two overlapping bands are set.") {
+
+            const std::vector<cv::Scalar> min {cv::Scalar(10, 50, 40),
+                                               cv::Scalar(30, 0, 0)};
+            const std::vector<cv::Scalar> max {cv::Scalar(40, 255, 255),
+                                               cv::Scalar(90, 256, 256)};
+            classifier.set(min, max);
+
+            THEN ("Each mask matches its band, on whole frames and on "
+                  "non-continuous regions of interest.") {
+                for (const auto &f : frames) {
+                    checkClassifier(classifier, f, min, max);
+                    checkClassifier(classifier,
+                                    f(cv::Rect(3, 5, f.cols / 2 + 1, f.rows / 2)),
+                                    min, max);
+                }
+            }
+        }
+
+        WHEN ("The maximum number of bands is set, including nested and "
+              "edge bands.") {
+
+            std::vector<cv::Scalar> min, max;
+            for (size_t k = 0; k < oat::MAX_HSV_CLASSES; k++) {
+                const double h = 20.0 * k;
+                min.emplace_back(h, 10.0 * k, 0);
+                max.emplace_back(h + 40, 256, 255 - 10.0 * k);
+            }
+            min[0] = cv::Scalar(0, 0, 0);
+            max[0] = cv::Scalar(256, 256, 256);
+
+            classifier.set(min, max);
+
+            THEN ("Each mask matches its band.") {
+                for (const auto &f : frames)
+                    checkClassifier(classifier, f, min, max);
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+//******************************************************************************
+//* File:   HSVThreshold_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <utility>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/positiondetector/HSVThreshold.h"
+
+using Band = std::pair<cv::Scalar, cv::Scalar>;
+
+// Narrow and wide bands, and bands on the edges of the 8-bit HSV ranges,
+// including upper bounds of 256
+static const std::vector<Band> BANDS {
+    {cv::Scalar(10, 50, 40), cv::Scalar(40, 255, 255)},
+    {cv::Scalar(0, 0, 0), cv::Scalar(180, 255, 255)},
+    {cv::Scalar(0, 0, 0), cv::Scalar(256, 256, 256)},
+    {cv::Scalar(0, 0, 0), cv::Scalar(0, 0, 0)},
+    {cv::Scalar(170, 100, 0), cv::Scalar(256, 256, 256)},
+    {cv::Scalar(90, 0, 200), cv::Scalar(130, 30, 256)}
+};
+
+// The same threshold using OpenCV
+static cv::Mat referenceMask(const cv::Mat &frame, const Band &band) {
+
+    cv::Mat hsv, mask;
+    cv::cvtColor(frame, hsv, cv::COLOR_BGR2HSV);
+    cv::inRange(hsv, band.first, band.second, mask);
+    return mask;
+}
+
+static void checkThreshold(const oat::HSVThreshold &threshold,
+                           const cv::Mat &frame,
+                           const Band &band) {
+
+    cv::Mat mask;
+    threshold.apply(frame, mask);
+
+    REQUIRE (mask.size() == frame.size());
+    REQUIRE (mask.type() == CV_8UC1);
+    REQUIRE (cv::countNonZero(mask != referenceMask(frame, band)) == 0);
+}
+
+SCENARIO ("HSVThreshold matches cvtColor followed by inRange.", "[HSVThreshold]") {
+
+    GIVEN ("Random BGR frames, and slices of every G, R pair at several B.") {
+
+        cv::RNG rng(0x0a7);
+        std::vector<cv::Mat> frames;
+        for (const auto &s : {cv::Size(64, 48), cv::Size(63, 37)}) {
+            cv::Mat f(s, CV_8UC3);
+            rng.fill(f, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+            frames.push_back(f);
+        }
+
+        for (const int b : {0, 1, 127, 254, 255}) {
+            cv::Mat f(256, 256, CV_8UC3);
+            for (int g = 0; g < 256; g++)
+                for (int r = 0; r < 256; r++)
+                    f.at<cv::Vec3b>(g, r) = cv::Vec3b(b, g, r);
+            frames.push_back(f);
+        }
+
+        oat::HSVThreshold threshold;
+
+        WHEN ("Whole frames are thresholded.") {
+
+            THEN ("Masks match for each pass band.") {
+                for (const auto &band : BANDS) {
+                    threshold.set(band.first, band.second);
+                    for (const auto &f : frames)
+                        checkThreshold(threshold, f, band);
+                }
+            }
+        }
+
+        WHEN ("Non-continuous regions of interest are thresholded.") {
+
+            THEN ("Masks match for each pass band.") {
+                for (const auto &band : BANDS) {
+                    threshold.set(band.first, band.second);
+                    for (const auto &f : frames) {
+                        const cv::Mat roi = f(cv::Rect(3, 5, f.cols / 2 + 1, f.rows / 2));
+                        REQUIRE (!roi.isContinuous());
+                        checkThreshold(threshold, roi, band);
+                    }
+                }
+            }
+        }
+    }
+}
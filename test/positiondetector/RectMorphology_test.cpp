@@ -0,0 +1,149 @@
+//******************************************************************************
+//* File:   RectMorphology_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/positiondetector/RectMorphology.h"
+
+static const std::vector<int> KERNEL_SIZES {1, 2, 3, 4, 5, 8, 15, 31};
+
+// Apply erosion or dilation in place and with OpenCV, and compare. The
+// reference works on a copy so that OpenCV does not read pixels outside a
+// region of interest.
+static void checkMorphology(oat::RectMorphology &morphology,
+                            const cv::Mat &frame,
+                            const int size,
+                            const bool erode) {
+
+    const cv::Mat kernel =
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size));
+
+    cv::Mat ref;
+    if (erode)
+        cv::erode(frame.clone(), ref, kernel);
+    else
+        cv::dilate(frame.clone(), ref, kernel);
+
+    cv::Mat result = frame.clone();
+    if (erode)
+        morphology.erode(result, size);
+    else
+        morphology.dilate(result, size);
+
+    REQUIRE (cv::countNonZero(result != ref) == 0);
+}
+
+// Grayscale frame and binary mask of the given size
+static std::vector<cv::Mat> randomFrames(cv::RNG &rng, const cv::Size &size) {
+
+    cv::Mat gray(size, CV_8UC1);
+    rng.fill(gray, cv::RNG::UNIFORM, 0, 256);
+
+    cv::Mat noise(size, CV_8UC1);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 100);
+    cv::Mat mask = noise < 30;
+
+    return {gray, mask};
+}
+
+SCENARIO ("RectMorphology matches cv::erode and cv::dilate with a rectangular kernel.", "[RectMorphology]") {
+
+    GIVEN ("Random grayscale frames and masks of odd and even size.") {
+
+        cv::RNG rng(0x0a7);
+        std::vector<cv::Mat> frames;
+        for (const auto &s : {cv::Size(64, 48), cv::Size(63, 37),
+                              cv::Size(1, 20), cv::Size(20, 1)}) {
+            for (const auto &f : randomFrames(rng, s))
+                frames.push_back(f);
+        }
+
+        // Reused across calls so that working buffers are resized
+        oat::RectMorphology morphology;
+
+        WHEN ("Frames are eroded by odd and even kernels.") {
+
+            THEN ("Results match, including at the frame edges.") {
+                for (const int k : KERNEL_SIZES)
+                    for (const auto &f : frames)
+                        checkMorphology(morphology, f, k, true);
+            }
+        }
+
+        WHEN ("Frames are dilated by odd and even kernels.") {
+
+            THEN ("Results match, including at the frame edges.") {
+                for (const int k : KERNEL_SIZES)
+                    for (const auto &f : frames)
+                        checkMorphology(morphology, f, k, false);
+            }
+        }
+    }
+
+    GIVEN ("A frame smaller than the kernel.") {
+
+        cv::RNG rng(0x0a7);
+        const auto frames = randomFrames(rng, cv::Size(5, 4));
+        oat::RectMorphology morphology;
+
+        THEN ("Results match.") {
+            for (const int k : {7, 8, 31})
+                for (const auto &f : frames) {
+                    checkMorphology(morphology, f, k, true);
+                    checkMorphology(morphology, f, k, false);
+                }
+        }
+    }
+
+    GIVEN ("A region of interest of a larger frame.") {
+
+        cv::RNG rng(0x0a7);
+        const cv::Mat frame = randomFrames(rng, cv::Size(64, 48))[0];
+        const cv::Rect roi(5, 3, 41, 30);
+        oat::RectMorphology morphology;
+
+        WHEN ("The region is eroded in place.") {
+
+            cv::Mat result = frame.clone();
+            cv::Mat view = result(roi);
+            morphology.erode(view, 5);
+
+            THEN ("Pixels outside the region do not take part.") {
+
+                cv::Mat ref;
+                cv::erode(frame(roi).clone(), ref,
+                          cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5, 5)));
+                REQUIRE (cv::countNonZero(result(roi) != ref) == 0);
+            }
+
+            THEN ("Pixels outside the region are unchanged.") {
+
+                result(roi).setTo(0);
+                cv::Mat outside = frame.clone();
+                outside(roi).setTo(0);
+                REQUIRE (cv::countNonZero(result != outside) == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+//******************************************************************************
+//* File:   SampleQueue_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../src/recorder/SampleQueue.h"
+
+SCENARIO ("Positions are queued in order, whether pooled or spilled.", "[SampleQueue]") {
+
+    GIVEN ("A position queue with a single pool element that spills.") {
+
+        const std::atomic<bool> running {true};
+
+        oat::Position2D p("test");
+        oat::SampleQueue<oat::Position2D> q(p, 1, oat::OverflowPolicy::SPILL, ".");
+
+        WHEN ("More positions are pushed than the pool holds.") {
+
+            for (int i = 0; i < 4; i++) {
+                p.sample().incrementCount();
+                p.position = oat::Point2D(i, 2 * i);
+                p.position_valid = true;
+                p.position_held = i % 2 == 1;
+                std::strcpy(p.region, i == 3 ? "arena" : "");
+                p.region_valid = i == 3;
+                REQUIRE (q.push(p, 10 + i, running));
+            }
+
+            std::vector<oat::Position2D> out;
+            std::vector<uint64_t> tags;
+            q.consume([&](const oat::Position2D &s, const uint64_t tag) {
+                out.push_back(s);
+                tags.push_back(tag);
+                return true;
+            });
+
+            THEN ("Overflowing positions are spilled.") {
+                REQUIRE (q.telemetry().spilled == 3);
+                REQUIRE (q.telemetry().depth == 0);
+            }
+
+            THEN ("Every field comes back, in order.") {
+                REQUIRE (out.size() == 4);
+                for (int i = 0; i < 4; i++) {
+                    REQUIRE (tags[i] == static_cast<uint64_t>(10 + i));
+                    REQUIRE (out[i].sample().count() == static_cast<uint64_t>(i + 1));
+                    REQUIRE (out[i].position.x == i);
+                    REQUIRE (out[i].position.y == 2 * i);
+                    REQUIRE (out[i].position_valid);
+                    REQUIRE (out[i].position_held == (i % 2 == 1));
+                    REQUIRE (out[i].region_valid == (i == 3));
+                }
+                REQUIRE (std::string(out[3].region) == "arena");
+            }
+        }
+    }
+}
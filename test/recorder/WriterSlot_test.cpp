@@ -0,0 +1,170 @@
+//******************************************************************************
+//* File:   WriterSlot_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../src/recorder/RecordGate.h"
+#include "../../src/recorder/SampleQueue.h"
+#include "../../src/recorder/Writer.h"
+#include "../../src/recorder/WriterSlot.h"
+
+using Slot = oat::WriterSlot<oat::Position2D, oat::Writer<oat::Position2D>>;
+
+// Records which samples it was asked to write or skip
+class CountWriter : public oat::Writer<oat::Position2D> {
+
+public:
+
+    explicit CountWriter(const std::string &path) : Writer(path) { }
+
+    void initialize(const std::string &, const oat::Position2D &) override { }
+    void write(const oat::Position2D &p) override {
+        written.push_back(p.sample().count());
+    }
+    void skip(const oat::Position2D &p) override {
+        skipped.push_back(p.sample().count());
+    }
+
+    std::vector<uint64_t> written, skipped;
+};
+
+// Acquire a sample into the slot as the recorder does, rotating to
+// file_set first if it is newer than the slot's
+static void acquire(Slot &slot,
+                    oat::Position2D &p,
+                    const uint64_t file_set,
+                    std::unique_ptr<CountWriter> &next) {
+
+    static const std::atomic<bool> running {true};
+
+    p.sample().incrementCount();
+    REQUIRE (slot.queue->push(p, file_set, running));
+
+    if (file_set != slot.file_set) {
+        slot.retired_writer = std::move(slot.writer);
+        slot.writer = std::move(next);
+        slot.file_set = file_set;
+    }
+}
+
+SCENARIO ("Writers are retired once all samples of their file set are written.", "[WriterSlot]") {
+
+    GIVEN ("A slot that has written samples to its first file set.") {
+
+        const std::string path0 = "WriterSlot_test_0.dat";
+        const std::string path1 = "WriterSlot_test_1.dat";
+
+        oat::Position2D p("test");
+        Slot slot;
+        slot.queue = std::unique_ptr<oat::SampleQueue<oat::Position2D>>(
+            new oat::SampleQueue<oat::Position2D>(p, 16, oat::OverflowPolicy::BLOCK, ""));
+
+        auto *w0 = new CountWriter(path0);
+        slot.writer = std::unique_ptr<oat::Writer<oat::Position2D>>(w0);
+        std::unique_ptr<CountWriter> next(new CountWriter(path1));
+        auto *w1 = next.get();
+
+        std::vector<std::unique_ptr<oat::Writer<oat::Position2D>>> retired;
+
+        WHEN ("The slot rotates while the gate holds samples for the pre-roll.") {
+
+            // Samples are only decided pre_roll samples after they arrive
+            oat::RecordGate gate(1, 2, 0);
+            slot.gated = true;
+
+            for (int i = 0; i < 3; i++) {
+                acquire(slot, p, 0, next);
+                gate.update(0, p.sample().count(), false);
+            }
+            oat::drainWriterSlot(slot, &gate, retired);
+
+            THEN ("Samples within the pre-roll are held.") {
+                REQUIRE (w0->skipped == std::vector<uint64_t> {1});
+                REQUIRE (w0->written.empty());
+            }
+
+            acquire(slot, p, 1, next);
+            gate.update(0, p.sample().count(), false);
+            oat::drainWriterSlot(slot, &gate, retired);
+
+            THEN ("The old writer is kept while one of its samples is held.") {
+                REQUIRE (w0->skipped == (std::vector<uint64_t> {1, 2}));
+                REQUIRE (slot.retired_writer.get() == w0);
+                REQUIRE (retired.empty());
+            }
+
+            acquire(slot, p, 1, next);
+            gate.update(0, p.sample().count(), true);
+            oat::drainWriterSlot(slot, &gate, retired);
+
+            THEN ("Held samples go to the old writer, which is then retired.") {
+                REQUIRE (w0->written == std::vector<uint64_t> {3});
+                REQUIRE (w1->written == (std::vector<uint64_t> {4, 5}));
+                REQUIRE (w1->skipped.empty());
+                REQUIRE (retired.size() == 1);
+                REQUIRE (retired[0].get() == w0);
+                REQUIRE (!slot.retired_writer);
+            }
+        }
+
+        WHEN ("The slot rotates without a gate.") {
+
+            acquire(slot, p, 0, next);
+            oat::drainWriterSlot(slot, nullptr, retired);
+
+            acquire(slot, p, 1, next);
+            acquire(slot, p, 1, next);
+            oat::drainWriterSlot(slot, nullptr, retired);
+
+            THEN ("Each writer gets its file set's samples and the old one is retired.") {
+                REQUIRE (w0->written == std::vector<uint64_t> {1});
+                REQUIRE (w1->written == (std::vector<uint64_t> {2, 3}));
+                REQUIRE (retired.size() == 1);
+                REQUIRE (retired[0].get() == w0);
+            }
+        }
+
+        WHEN ("Samples of the next file set are queued before the slot switches to it.") {
+
+            acquire(slot, p, 0, next);
+            p.sample().incrementCount();
+            static const std::atomic<bool> running {true};
+            REQUIRE (slot.queue->push(p, 1, running));
+            oat::drainWriterSlot(slot, nullptr, retired);
+
+            THEN ("They stay queued.") {
+                REQUIRE (w0->written == std::vector<uint64_t> {1});
+                REQUIRE (w1->written.empty());
+                REQUIRE (slot.queue->telemetry().depth == 1);
+            }
+        }
+
+        std::remove(path0.c_str());
+        std::remove(path1.c_str());
+    }
+}
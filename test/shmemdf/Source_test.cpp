@@ -117,6 +117,42 @@ SCENARIO ("Sources must connect() before waiting or posting.", "[Source]") {
     }
 }
 
+SCENARIO ("Sources can wait for a SINK with a timeout.", "[Source]") {
+
+    GIVEN ("A bound Sink<int> and a connected Source<int> with common node address") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+        oat::NodeState state {oat::NodeState::UNDEFINED};
+
+        INFO ("The sink binds a node");
+        sink.bind(node_addr);
+
+        INFO ("The source connects to the node");
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The source calls wait_for() before the sink has posted") {
+            THEN ("The wait shall time out and leave state unset") {
+                REQUIRE_FALSE( source.wait_for(20, state) );
+                REQUIRE( state == oat::NodeState::UNDEFINED );
+            }
+        }
+
+        WHEN ("The source calls wait_for() after the sink has posted") {
+
+            sink.wait();
+            sink.post();
+
+            THEN ("The wait shall succeed and the source shall post") {
+                REQUIRE( source.wait_for(20, state) );
+                REQUIRE( state == oat::NodeState::SINK_BOUND );
+                REQUIRE_NOTHROW( source.post(); );
+            }
+        }
+    }
+}
+
 SCENARIO ("Sources cannot connect() to the same node more than once.", "[Source]") {
 
         oat::Sink<int> sink;
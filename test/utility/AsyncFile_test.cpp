@@ -0,0 +1,107 @@
+//******************************************************************************
+//* File:   AsyncFile_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "../../lib/utility/AsyncFile.h"
+
+static std::string readFile(const std::string &path) {
+
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+SCENARIO ("Data appended to an asynchronous file is written in order.", "[AsyncFile]") {
+
+    GIVEN ("An asynchronous file with blocks that are smaller than the data.") {
+
+        const std::string path = "AsyncFile_test.dat";
+
+        std::string expected;
+        for (int i = 0; i < 1000; i++)
+            expected += std::to_string(i) + ",";
+
+        WHEN ("Data is appended in pieces and the file is destroyed.") {
+
+            {
+                oat::AsyncFile f(path, 16, 3);
+                size_t i = 0;
+                while (i < expected.size()) {
+                    size_t n = std::min<size_t>(i % 37 + 1, expected.size() - i);
+                    if (n == 1)
+                        f.put(expected[i]);
+                    else
+                        f.append(expected.data() + i, n);
+                    i += n;
+                }
+
+                REQUIRE (f.size() == expected.size());
+            }
+
+            THEN ("The file holds all data.") {
+                REQUIRE (readFile(path) == expected);
+            }
+        }
+
+        WHEN ("Blocks are written by several I/O threads at once.") {
+
+            {
+                oat::AsyncFile f(path, 16, 8, 4);
+                for (size_t i = 0; i < expected.size(); i += 5)
+                    f.append(expected.data() + i,
+                             std::min<size_t>(5, expected.size() - i));
+            }
+
+            THEN ("The file holds all data.") {
+                REQUIRE (readFile(path) == expected);
+            }
+        }
+
+        WHEN ("Partial blocks are flushed between appends.") {
+
+            oat::AsyncFile f(path, 16, 2);
+            f.append("abc", 3);
+            f.flush();
+            f.append("defghijklmnopqrstuvwxyz", 23);
+            f.put('!');
+            f.sync();
+
+            THEN ("Synced data is visible before the file is destroyed.") {
+                REQUIRE (readFile(path) == "abcdefghijklmnopqrstuvwxyz!");
+            }
+        }
+
+        std::remove(path.c_str());
+    }
+
+    GIVEN ("A path in a folder that does not exist.") {
+
+        THEN ("Opening the file shall throw.") {
+            REQUIRE_THROWS (oat::AsyncFile {"does/not/exist/AsyncFile_test.dat"});
+        }
+    }
+}
@@ -0,0 +1,189 @@
+//******************************************************************************
+//* File:   FrameIndex_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../../lib/utility/FrameIndex.h"
+#include "../../lib/utility/PositionLog.h"
+
+namespace fi = oat::frameidx;
+
+// Write an index header followed by records
+static void writeIndex(const std::string &path,
+                       const fi::Header &header,
+                       const std::vector<fi::Record> &records) {
+
+    FILE *fd = fopen(path.c_str(), "wb");
+    REQUIRE (fd != nullptr);
+    fwrite(&header, sizeof(header), 1, fd);
+    if (!records.empty())
+        fwrite(records.data(), sizeof(fi::Record), records.size(), fd);
+    fclose(fd);
+}
+
+SCENARIO ("Recorded samples are located in the video through the frame index.", "[FrameIndex]") {
+
+    GIVEN ("An index of a video in which recording was paused for a few samples.") {
+
+        const std::string path = "FrameIndex_test.idx";
+
+        fi::Header h;
+        fi::initializeHeader(h, "raw", 30.0, fi::OFFSET | fi::KEYFRAME, "test", "date");
+
+        // Samples 100-105 and 110-115 were recorded. Every fourth frame is a
+        // key frame and encoded frames vary in size.
+        std::vector<fi::Record> records(12);
+        int64_t offset = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            records[i].tick = i < 6 ? 100 + i : 104 + i;
+            records[i].usec = records[i].tick * 33333;
+            records[i].frame = i;
+            records[i].offset = offset;
+            records[i].flags = i % 4 == 0 ? static_cast<uint32_t>(fi::KEY_FRAME) : 0;
+            offset += i % 4 == 0 ? 5000 : 700 + 10 * i;
+        }
+
+        writeIndex(path, h, records);
+        fi::Reader reader(path);
+
+        THEN ("The header declares offsets and key frames as known.") {
+            REQUIRE (reader.size() == records.size());
+            REQUIRE (reader.header().fields == (fi::OFFSET | fi::KEYFRAME));
+            REQUIRE (std::string(reader.header().source) == "raw");
+        }
+
+        WHEN ("A recorded sample is looked up.") {
+
+            const fi::Record &r = reader.record(reader.find(112));
+
+            THEN ("Its frame number and byte offset are found.") {
+                REQUIRE (r.tick == 112);
+                REQUIRE (r.frame == 8);
+                REQUIRE (r.offset == records[8].offset);
+            }
+        }
+
+        WHEN ("A sample that was not recorded is looked up.") {
+
+            THEN ("The first frame recorded after it is found.") {
+                REQUIRE (reader.find(107) == 6);
+                REQUIRE (reader.record(6).tick == 110);
+                REQUIRE (reader.find(99) == 0);
+                REQUIRE (reader.find(116) == reader.size());
+            }
+        }
+
+        WHEN ("Decoding must start from the key frame preceding a sample.") {
+
+            size_t i = reader.find(115);
+            while (i > 0 && !(reader.record(i).flags & fi::KEY_FRAME))
+                i--;
+
+            THEN ("It is found by walking back through the index.") {
+                REQUIRE (i == 8);
+                REQUIRE (reader.record(i).offset == records[8].offset);
+            }
+        }
+
+        WHEN ("A frame beyond the end of the index is requested.") {
+
+            THEN ("The reader shall throw.") {
+                REQUIRE_THROWS (reader.record(records.size()));
+            }
+        }
+
+        std::remove(path.c_str());
+    }
+
+    GIVEN ("An index written by an encoder that does not report offsets.") {
+
+        const std::string path = "FrameIndex_test.idx";
+
+        fi::Header h;
+        fi::initializeHeader(h, "raw", 30.0, 0, "test", "date");
+
+        std::vector<fi::Record> records(3);
+        for (size_t i = 0; i < records.size(); i++) {
+            records[i].tick = i;
+            records[i].frame = i;
+        }
+
+        writeIndex(path, h, records);
+        fi::Reader reader(path);
+
+        THEN ("Offsets are unknown.") {
+            REQUIRE (reader.header().fields == 0);
+            REQUIRE (reader.record(1).offset == -1);
+            REQUIRE (reader.record(1).flags == 0);
+        }
+
+        std::remove(path.c_str());
+    }
+}
+
+SCENARIO ("Files that cannot be read as frame indices are rejected.", "[FrameIndex]") {
+
+    GIVEN ("A position log.") {
+
+        const std::string path = "FrameIndex_test.pos";
+
+        oat::poslog::Header h;
+        oat::poslog::initializeHeader(h, "pos", 30.0, oat::poslog::ALL, "test", "date");
+
+        FILE *fd = fopen(path.c_str(), "wb");
+        REQUIRE (fd != nullptr);
+        fwrite(&h, sizeof(h), 1, fd);
+        std::vector<char> record(h.record_bytes, 0);
+        fwrite(record.data(), record.size(), 1, fd);
+        fclose(fd);
+
+        THEN ("The reader shall throw.") {
+            REQUIRE_THROWS (fi::Reader {path});
+        }
+
+        std::remove(path.c_str());
+    }
+
+    GIVEN ("A frame index whose header would leave records misaligned.") {
+
+        const std::string path = "FrameIndex_test.idx";
+
+        fi::Header h;
+        fi::initializeHeader(h, "raw", 30.0, 0, "test", "date");
+        h.header_bytes += 4;
+
+        FILE *fd = fopen(path.c_str(), "wb");
+        REQUIRE (fd != nullptr);
+        fwrite(&h, sizeof(h), 1, fd);
+        std::vector<char> pad(4 + sizeof(fi::Record), 0);
+        fwrite(pad.data(), pad.size(), 1, fd);
+        fclose(fd);
+
+        THEN ("The reader shall throw.") {
+            REQUIRE_THROWS (fi::Reader {path});
+        }
+
+        std::remove(path.c_str());
+    }
+}
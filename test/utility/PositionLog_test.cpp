@@ -0,0 +1,148 @@
+//******************************************************************************
+//* File:   PositionLog_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../lib/utility/PositionLog.h"
+
+namespace pl = oat::poslog;
+
+SCENARIO ("Position log records have a fixed size determined by their columns.", "[PositionLog]") {
+
+    GIVEN ("A column layout.") {
+
+        WHEN ("No optional columns are requested.") {
+
+            THEN ("Records contain only the fixed base fields.") {
+                REQUIRE (pl::recordBytes(0) == pl::RECORD_BASE_BYTES);
+                REQUIRE (pl::columnOffset(0, pl::POSITION) < 0);
+            }
+        }
+
+        WHEN ("Only the velocity and region columns are requested.") {
+
+            uint32_t cols = pl::VELOCITY | pl::REGION;
+
+            THEN ("Columns are packed in declaration order after the base fields.") {
+                REQUIRE (pl::recordBytes(cols) ==
+                         pl::RECORD_BASE_BYTES + pl::VECTOR_COLUMN_BYTES + pl::REGION_COLUMN_BYTES);
+                REQUIRE (pl::columnOffset(cols, pl::VELOCITY) == (std::ptrdiff_t)pl::RECORD_BASE_BYTES);
+                REQUIRE (pl::columnOffset(cols, pl::REGION) ==
+                         (std::ptrdiff_t)(pl::RECORD_BASE_BYTES + pl::VECTOR_COLUMN_BYTES));
+                REQUIRE (pl::columnOffset(cols, pl::HEADING) < 0);
+            }
+        }
+
+        WHEN ("All columns are requested.") {
+
+            THEN ("Records remain 8-byte aligned.") {
+                REQUIRE (pl::recordBytes(pl::ALL) % 8 == 0);
+            }
+        }
+    }
+}
+
+SCENARIO ("Position logs can be read back through a memory map.", "[PositionLog]") {
+
+    GIVEN ("A position log written with a subset of columns.") {
+
+        const std::string path = "PositionLog_test.pos";
+        const uint32_t cols = pl::POSITION | pl::REGION;
+        const size_t n = 10;
+
+        pl::Header h;
+        pl::initializeHeader(h, "pos", 30.0, cols, "test", "date");
+
+        FILE *fd = fopen(path.c_str(), "wb");
+        REQUIRE (fd != nullptr);
+        fwrite(&h, sizeof(h), 1, fd);
+
+        std::vector<char> buf(pl::recordBytes(cols));
+        for (size_t i = 0; i < n; i++) {
+            pl::Record r;
+            r.tick = i;
+            r.usec = i * 1000;
+            r.flags = pl::POSITION_VALID;
+            if (i % 2)
+                r.flags |= pl::POSITION_HELD;
+            r.position[0] = i;
+            r.position[1] = 2.0 * i;
+            r.velocity[0] = 1.0; // Not a requested column
+            strncpy(r.region, "north", sizeof(r.region) - 1);
+            pl::packRecord(r, cols, buf.data());
+            fwrite(buf.data(), buf.size(), 1, fd);
+        }
+
+        // Incomplete trailing record, as if the writer crashed
+        fwrite(buf.data(), buf.size() / 2, 1, fd);
+        fclose(fd);
+
+        WHEN ("The log is mapped by a reader.") {
+
+            pl::Reader reader(path);
+
+            THEN ("The header is recovered.") {
+                REQUIRE (reader.header().columns == cols);
+                REQUIRE (reader.header().sample_rate_hz == Approx(30.0));
+                REQUIRE (std::string(reader.header().source) == "pos");
+            }
+
+            THEN ("Only complete records are visible.") {
+                REQUIRE (reader.size() == n);
+                REQUIRE_THROWS (reader.data(n));
+            }
+
+            THEN ("Records round trip.") {
+                for (size_t i = 0; i < n; i++) {
+                    auto r = reader.record(i);
+                    REQUIRE (r.tick == i);
+                    REQUIRE (r.usec == (int64_t)(i * 1000));
+                    REQUIRE (r.flags == (i % 2 ? pl::POSITION_VALID | pl::POSITION_HELD
+                                               : pl::POSITION_VALID));
+                    REQUIRE (r.position[1] == Approx(2.0 * i));
+                    REQUIRE (r.velocity[0] == 0.0);
+                    REQUIRE (std::string(r.region) == "north");
+                }
+            }
+        }
+
+        std::remove(path.c_str());
+    }
+
+    GIVEN ("A file that is not a position log.") {
+
+        const std::string path = "PositionLog_test.txt";
+        FILE *fd = fopen(path.c_str(), "wb");
+        std::vector<char> junk(1024, 'x');
+        fwrite(junk.data(), junk.size(), 1, fd);
+        fclose(fd);
+
+        THEN ("The reader shall throw.") {
+            REQUIRE_THROWS (pl::Reader {path});
+        }
+
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,105 @@
+//******************************************************************************
+//* File:   TripleBuffer_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include "../../lib/utility/TripleBuffer.h"
+
+SCENARIO ("A triple buffer hands the latest value to the consumer.", "[TripleBuffer]") {
+
+    GIVEN ("A triple buffer initialized to a value.") {
+
+        oat::TripleBuffer<int> b(7);
+
+        THEN ("The consumer sees the initial value and no update.") {
+            REQUIRE (!b.update());
+            REQUIRE (b.front() == 7);
+        }
+
+        WHEN ("Several values are published before the consumer updates.") {
+
+            for (int i = 0; i < 5; i++) {
+                b.back() = i;
+                b.publish();
+            }
+
+            THEN ("Only the last value is taken, once.") {
+                REQUIRE (b.update());
+                REQUIRE (b.front() == 4);
+                REQUIRE (!b.update());
+                REQUIRE (b.front() == 4);
+            }
+        }
+
+        WHEN ("Values are published and taken alternately.") {
+
+            THEN ("Each value is taken.") {
+                for (int i = 0; i < 10; i++) {
+                    b.back() = i;
+                    b.publish();
+                    REQUIRE (b.update());
+                    REQUIRE (b.front() == i);
+                }
+            }
+        }
+    }
+
+    GIVEN ("A producer and a consumer thread.") {
+
+        struct Pair { int a; int b; };
+        oat::TripleBuffer<Pair> b(Pair {0, 0});
+        const int n = 100000;
+
+        WHEN ("The producer publishes increasing values.") {
+
+            std::atomic<bool> torn {false}, backwards {false};
+
+            std::thread consumer([&b, &torn, &backwards, n] {
+                int last = 0;
+                while (last < n) {
+                    if (!b.update())
+                        continue;
+                    const Pair &p = b.front();
+                    if (p.a != p.b)
+                        torn = true;
+                    if (p.a < last)
+                        backwards = true;
+                    last = p.a;
+                }
+            });
+
+            for (int i = 1; i <= n; i++) {
+                b.back().a = i;
+                b.back().b = i;
+                b.publish();
+            }
+
+            consumer.join();
+
+            THEN ("The consumer never sees partially written or older values.") {
+                REQUIRE (!torn);
+                REQUIRE (!backwards);
+            }
+        }
+    }
+}